@@ -0,0 +1,81 @@
+#ifndef SWM_AUTOPILOT_H
+#define SWM_AUTOPILOT_H
+
+#include <vector>
+#include "solarsystem.h"
+#include "flightplan.h"
+#include "jobsystem.h"
+#include "random.h"
+
+/*
+ * This class flies the spaceship to a planet without running into anything on the way.
+ * Orbits follow from the time alone, so a copy of the system is moved into the future and straight
+ * candidate courses from where the ship is are flown through it on all cores. The course that gets to
+ * the planet first wins, otherwise the one that ends closest to it, and courses that come too close
+ * to another body or go into a wormhole are never taken. The ship flies its course for a few frames
+ * and then plans again from where it is, keeping the last course as a candidate so it doesn't waver.
+ * A plan is flown through a few steps each frame, bounded by a number of distance tests, and starts
+ * where the ship will be once it's done, so crowded systems get fewer candidates, a shorter look ahead
+ * and plans spread over more frames instead of longer frames, and replays plan exactly the same way.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+class Autopilot
+{
+private:
+	JobSystem* jobs;
+
+	// the system the ship flies in and the copy the plans are flown through
+	SolarSystem* system;
+	SolarSystem* shadow;
+	FlightEvaluator* evaluator;
+	int target;
+
+	// the course being flown, a normalized direction
+	float heading[3];
+	bool hasHeading;
+	int framesSincePlan;
+	bool arrived;
+
+	// the plan being flown through, the steps it takes per frame, where the target is at its end
+	// and how close the ship may come to anything else
+	bool planning;
+	int planSteps;
+	double planStart;
+	float planEnd[3];
+	float planAllowed;
+
+	Random random;
+	std::vector<FlightPlan> candidates;
+	std::vector<FlightReport> reports;
+
+	// set up the candidates of a new plan
+	void startPlan(const float* position, const SimulationTime& time, double daysPerFrame, float speed);
+
+	// pick the course of the finished plan, return false if every candidate runs into something
+	bool choosePlan(void);
+
+	// where the target is after the given number of days from the time
+	void predictTarget(const SimulationTime& time, double days, float* position);
+	void addCandidate(const float* position, const float* direction, const SimulationTime& time, double days, float distance);
+public:
+	Autopilot(JobSystem* jobs);
+	~Autopilot(void);
+
+	// start flying to a planet of the system, which is only read
+	// return false if the system is too crowded to plan through within the work of a frame
+	bool engage(SolarSystem* system, int planet);
+	void disengage(void);
+	bool isEngaged(void);
+	SolarSystem* getSystem(void);
+
+	// called once per frame with where the ship is, the days and distance it goes per frame
+	// write the direction to fly this frame, a zero one while the first course is planned,
+	// return false and disengage once the ship is there or when there is no safe way left
+	bool fly(const float* position, const SimulationTime& time, double daysPerFrame, float speed, float* direction);
+
+	// whether the last call of fly ended at the target
+	bool hasArrived(void);
+};
+
+#endif
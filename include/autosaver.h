@@ -0,0 +1,55 @@
+#ifndef SWM_AUTOSAVER_H
+#define SWM_AUTOSAVER_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "savegame.h"
+
+/*
+ * This class writes saves on a background thread into a rotating set of slots.
+ * The main thread only fills in a snapshot, everything else happens on the worker, so
+ * saving never stalls a frame. When saves come faster than they can be written, only
+ * the newest waiting snapshot is kept.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+class AutoSaver
+{
+private:
+	std::string prefix;
+	int slotCount;
+	int nextSlot;
+	uint32_t sequence;
+
+	std::thread worker;
+	std::mutex lock;
+	std::condition_variable wake;
+	bool stopping;
+
+	// the snapshot waiting to be written, and snapshots free for reuse
+	SaveSnapshot* pending;
+	std::vector<SaveSnapshot*> spare;
+
+	void run(void);
+	std::string slotPath(int slot);
+public:
+	// slots are named prefix0.dat, prefix1.dat and so on
+	AutoSaver(const char* prefix, int slotCount);
+
+	// finish the waiting save and stop the worker
+	~AutoSaver(void);
+
+	// get a snapshot to fill in, its vectors keep their memory from earlier saves
+	SaveSnapshot* begin(void);
+
+	// hand a filled snapshot to the worker, the numbering is done here
+	void submit(SaveSnapshot* snapshot);
+
+	// read the newest slot that is valid
+	bool loadLatest(SaveSnapshot* snapshot);
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef SWM_BODY_H
+#define SWM_BODY_H
+
+#include <stdint.h>
+
+// the name of the texture a body is drawn with, the same number as a texture name of OpenGL
+// the simulation only carries it around, so nothing but the drawing needs OpenGL
+typedef unsigned int TextureHandle;
+
+/*
+ * A flat description of a single body of a solar system.
+ * It is used to save, restore and copy systems without touching the objects themselves.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+enum BodyKind
+{
+	BODY_PLANET = 0,
+	BODY_MOON = 1,
+	BODY_WORMHOLE = 2,
+
+	// number of kinds, keep it last
+	BODY_KIND_COUNT
+};
+
+// the shape and tilt of an orbit besides its size and time, all zero for the old circles
+// angles are in degrees, counted from the y axis towards the x axis like the circles always went round
+struct OrbitElements
+{
+	// 0 for a circle, up to but not including 1
+	float eccentricity;
+	float inclination;
+
+	// direction of the line where the orbit rises through the plane of the system
+	float ascendingNode;
+
+	// angle from the ascending node to the closest point of the orbit
+	float periapsis;
+
+	// angle of the body along its orbit at time 0, as if it went round evenly
+	float meanAnomaly;
+};
+
+struct BodyDesc
+{
+	int kind;
+
+	// index of the description of the planet a moon orbits, -1 for others
+	int parent;
+
+	// distance from the sun, or from the planet for moons, half the long axis of an ellipse
+	float distance;
+	float orbitTime;
+	float rotationTime;
+	float radius;
+	TextureHandle textureHandle;
+	OrbitElements elements;
+};
+
+// The following are the layouts of bodies and texture names in files, all little-endian.
+struct BodyRecord
+{
+	int32_t kind;
+
+	// index of the record of the parent planet, -1 for others
+	int32_t parent;
+	float distance;
+	float orbitTime;
+	float rotationTime;
+	float radius;
+
+	// index into the texture names, -1 for no texture
+	int32_t asset;
+	int32_t reserved;
+	OrbitElements elements;
+};
+
+struct AssetRecord
+{
+	char name[64];
+};
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef SWM_BODYSTORE_H
+#define SWM_BODYSTORE_H
+
+#include <vector>
+#include "body.h"
+#include "kepler.h"
+
+/*
+ * The properties of every kind of body, fixed at compile time.
+ * A new kind of body only needs a value in BodyKind and a specialization here.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+template <int Kind>
+struct BodyTraits;
+
+template <>
+struct BodyTraits<BODY_PLANET>
+{
+	// orbits are drawn with this angular step, 0 for no orbit
+	static constexpr float orbitStep = 0.05f;
+
+	// direction of the spin around the axis
+	static constexpr float spinSign = 1.0f;
+
+	// a body at the center is a sun, drawn unlit and not too big
+	static constexpr bool canBeSun = true;
+	static constexpr bool collides = true;
+};
+
+template <>
+struct BodyTraits<BODY_MOON>
+{
+	static constexpr float orbitStep = 0.1f;
+	static constexpr float spinSign = -1.0f;
+	static constexpr bool canBeSun = false;
+	static constexpr bool collides = true;
+};
+
+template <>
+struct BodyTraits<BODY_WORMHOLE>
+{
+	static constexpr float orbitStep = 0.0f;
+	static constexpr float spinSign = 1.0f;
+	static constexpr bool canBeSun = true;
+	static constexpr bool collides = false;
+};
+
+/*
+ * This class stores all bodies of a solar system as contiguous arrays of components.
+ * Bodies are grouped by kind in the order of BodyKind, so a parent always comes before its moons
+ * and systems run over one kind at a time without branching on it.
+ * Since parents come first, the hierarchy is flattened into world transforms in a single pass.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+struct BodyOrbit
+{
+	// distance from the sun, or from the parent for moons, half the long axis of an ellipse
+	float distance;
+	float orbitTime;
+	OrbitElements elements;
+
+	// directions to the closest point of the orbit and to a quarter turn on from it,
+	// as long as the half axes, so a body sits at major * (cos E - e) + minor * sin E
+	float major[3];
+	float minor[3];
+
+	// turns gone round the orbit since the mean anomaly of the elements, wrapped to less than one
+	double phase;
+};
+
+struct BodySpin
+{
+	float rotationTime;
+
+	// current angle around the axis in degrees
+	float rotation;
+
+	// turns around the axis, wrapped to less than one
+	double phase;
+};
+
+struct BodyPosition
+{
+	// position relative to the parent, or to the sun, before distance scaling
+	float x, y, z;
+};
+
+struct BodyTransform
+{
+	// column-major world matrix in the space of the system, with distance scaling applied
+	// the center of the body is in matrix[12], matrix[13] and matrix[14]
+	float matrix[16];
+
+	// radius of the body as drawn
+	float radius;
+};
+
+// a kind as a type, to pick the overload that runs it
+template <int Kind>
+struct BodyKindTag
+{
+};
+
+class BodyStore
+{
+private:
+	// first index of every kind, and one past the last body
+	int first[BODY_KIND_COUNT + 1];
+
+	// run a system on the kinds from Kind on, the overload for BODY_KIND_COUNT ends it
+	template <class System>
+	void runFrom(System& system, BodyKindTag<BODY_KIND_COUNT>)
+	{
+	}
+
+	template <int Kind, class System>
+	void runFrom(System& system, BodyKindTag<Kind>)
+	{
+		run<Kind>(system);
+		runFrom(system, BodyKindTag<Kind + 1>());
+	}
+public:
+	std::vector<int> kinds;
+	std::vector<int> parents;
+	std::vector<BodyOrbit> orbits;
+	std::vector<BodySpin> spins;
+	std::vector<float> radii;
+	std::vector<TextureHandle> materials;
+	std::vector<BodyPosition> positions;
+
+	// where the bodies are along their orbits, solved for all of them at once
+	KeplerSolver kepler;
+
+	// resolved once per frame, in the same order as the bodies
+	std::vector<BodyTransform> transforms;
+
+	BodyStore(void);
+
+	// append a body, which must not be of an earlier kind than the last one
+	// return the index of the body, or -1 if it is out of order
+	int add(int kind, int parent, float distance, float orbitTime, float rotationTime, float radius, TextureHandle material,
+		const OrbitElements& elements);
+	void reserve(int count);
+	int size(void) const;
+	int begin(int kind) const;
+	int end(int kind) const;
+	int count(int kind) const;
+
+	// bytes taken by the components
+	size_t getMemoryFootprint(void) const;
+
+	// run a system on all bodies of one kind, with the traits of that kind
+	template <int Kind, class System>
+	void run(System& system)
+	{
+		int last = first[Kind + 1];
+		for (int i = first[Kind]; i < last; i++)
+		{
+			system.template apply<Kind, BodyTraits<Kind> >(*this, i);
+		}
+	}
+
+	// run a system on all bodies, kind by kind in the order of BodyKind
+	template <class System>
+	void runAll(System& system)
+	{
+		runFrom(system, BodyKindTag<0>());
+	}
+};
+
+#endif
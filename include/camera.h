@@ -1,25 +1,48 @@
 #ifndef SWM_CAMERA_H
 #define SWM_CAMERA_H
 
+#include "vecmath.h"
+
 /*
  * This class implements functions needed for camera manipulation.
  * It could be used to modify views from the spaceship. Though in fact the view
  * of the user is changed, it still simulates the motion of the spaceship.
+ * The motion is in camera.cpp and needs no OpenGL, setting up the view and saving images is in cameraview.cpp.
+ * The orientation is a unit quaternion, so turning for a long time never skews it, and the axes turned
+ * by the mouse are worked out once when something changed and then shared by the view and the motion.
  * Note that most of the names of the members are self-explanatory.
  */
 
-class Camera
+// a plain copy of the camera, used for saving, the orientation is kept as its axes
+struct CameraState
 {
-friend class SolarSystem;
-private:
-	// a vector pointing in the direction you're facing
 	float forwardVec[3];
-
-	// a vector pointing to the right of the front 
 	float rightVec[3];
-
-	// a vector pointing upwards from the front
 	float upVec[3];
+	float position[3];
+	float cameraSpeed;
+	float cameraTurnSpeed;
+	float mouseUpDown;
+	float mouseLeftRight;
+};
+
+// helpers for vectors of three floats and 3x3 rotation matrices
+void vectorSet(float* vec, float x, float y, float z);
+void vectorAdd(float* v1, float* v2);
+void vectorCopy(float* v1, float* v2);
+void vectorMul(float* vec, float scalar);
+float lengthOfVec(float* vec);
+void normalizeVec(float* vec);
+void rotationMatrix(float* matrix, float* axis, float angle);
+void mulVecBy(float* v1, float* matrix, float* v2);
+void rotateAroundVec(float* v1, float* v2, float angle, float* v3);
+
+class Camera
+{
+friend class SolarSystem;
+private:
+	// turns the x axis to the right, the y axis to the front and the z axis upwards
+	Quat orientation;
 
 	// a vector describing the position of the camera
 	float position[3];
@@ -32,18 +55,43 @@ private:
 	float mouseUpDown;
 	float mouseLeftRight;
 
+	// the axes turned by the mouse, valid unless viewChanged is set
+	Vec3 viewForward;
+	Vec3 viewUp;
+	Vec3 viewRight;
+	bool viewChanged;
+
+	// the orientation turned by the mouse angles
+	Quat turnWithMouse(float theta, float phi);
+	void updateView(void);
+
+	// set the orientation from its axes
+	void setAxes(Vec3 forward, Vec3 right, Vec3 up);
+
 public:
 	Camera(void);
 	void reset(void);
 
+	// copy the camera into a plain state and back
+	void getState(CameraState* state);
+	void setState(const CameraState* state);
+
 	// transform the OpenGL view matrix for the orientation
 	void transformOrientation(void);
 
 	// transform the OpenGL view matrix for the translation
 	void transformTranslation(void);
+	void getPosition(float* vec);
+
+	// the direction the camera looks in, including the mouse offset
+	void getViewDirection(float* vec);
+
+	// move the camera by the vector without turning it, used when the origin of the world moves
+	void shift(float* vec);
 	void pointAt(float* targetVec);
 	void speedUp(void);
 	void slowDown(void);
+	float getSpeed(void);
 
 	// move the camera forward
 	void forward(void);
@@ -71,6 +119,9 @@ public:
 
 	// save the snapshot
 	void saveImage(void);
+
+	// save a snapshot of any size by rendering the scene tile by tile, each tile no larger than the viewport
+	void saveTiledImage(int width, int height, void (*renderScene)(void));
 };
 
 #endif
\ No newline at end of file
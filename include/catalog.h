@@ -0,0 +1,96 @@
+#ifndef SWM_CATALOG_H
+#define SWM_CATALOG_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "body.h"
+#include "mappedfile.h"
+
+/*
+ * These classes read and write catalogs of solar systems.
+ * A catalog is compiled from a text source into a binary file of a header, an index with an
+ * entry per system, the bodies of all systems and the texture names. The binary is mapped and
+ * read in place, so finding a system is a single index lookup however many systems there are.
+ * Systems are numbered from 0 in the order they are written.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+const uint32_t catalogVersion = 2;
+
+// The following are the layout of a catalog on the disk, all little-endian.
+struct CatalogHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t systemCount;
+	uint64_t bodyCount;
+	uint32_t assetCount;
+	uint32_t reserved;
+	uint64_t indexOffset;
+	uint64_t bodiesOffset;
+	uint64_t assetsOffset;
+	uint64_t fileSize;
+};
+
+struct CatalogEntry
+{
+	uint64_t firstBody;
+	uint32_t bodyCount;
+	uint32_t reserved;
+};
+
+class Catalog
+{
+private:
+	MappedFile file;
+	const CatalogHeader* header;
+	const CatalogEntry* entries;
+	const BodyRecord* bodies;
+	const AssetRecord* assets;
+public:
+	Catalog(void);
+
+	// map the catalog and check its layout, the systems themselves are checked when they are read
+	bool open(const char* path);
+	uint64_t getSystemCount(void);
+	uint32_t getAssetCount(void);
+	const char* getAssetName(uint32_t index);
+
+	// describe a system, textures maps the texture names of the catalog to texture handles
+	bool getSystem(uint64_t index, const std::vector<TextureHandle>& textures, std::vector<BodyDesc>& bodies);
+
+	// compile a text source into a catalog, a message is left in error if the source is broken
+	static bool compile(const char* sourcePath, const char* catalogPath, std::string* error);
+};
+
+class CatalogWriter
+{
+private:
+	FILE* file;
+	uint64_t systemCount;
+	uint64_t systemsWritten;
+	uint64_t bodiesWritten;
+	std::vector<AssetRecord> assets;
+
+	// index entries waiting to be written
+	std::vector<CatalogEntry> pending;
+	uint64_t pendingFirst;
+
+	bool flushIndex(void);
+public:
+	CatalogWriter(void);
+	~CatalogWriter(void);
+
+	// start a catalog of a known number of systems using the texture names
+	bool open(const char* path, uint64_t systemCount, const std::vector<std::string>& assetNames);
+
+	// append the next system, parents and assets of the records are relative to the system and the catalog
+	bool addSystem(const BodyRecord* records, uint32_t count);
+
+	// write the index and the header, fails if fewer systems were added than announced
+	bool close(void);
+};
+
+#endif
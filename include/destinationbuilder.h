@@ -0,0 +1,72 @@
+#ifndef SWM_DESTINATIONBUILDER_H
+#define SWM_DESTINATIONBUILDER_H
+
+#include <vector>
+#include <stdint.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "solarsystem.h"
+#include "systemgenerator.h"
+#include "catalog.h"
+
+/*
+ * This class builds the solar system behind a wormhole on a background thread.
+ * The build is started while the spaceship approaches the wormhole, so the jump itself
+ * is only a pointer swap. Systems left behind are destroyed on the same thread.
+ * Systems are identified by an id, ids below the number of systems in the catalog are
+ * systems of the catalog, with 0 being our own solar system, and any other id is the seed
+ * the system is generated from.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+class DestinationBuilder
+{
+private:
+	const SystemGenerator* generator;
+	Catalog* catalog;
+
+	// texture handles for the texture names of the catalog
+	std::vector<TextureHandle> catalogTextures;
+	std::thread worker;
+	std::mutex lock;
+	std::condition_variable wake;
+	bool stopping;
+
+	// a build is asked for, and its result once it's done
+	bool requested;
+	uint64_t requestedId;
+	SolarSystem* ready;
+	uint64_t readyId;
+
+	// systems waiting to be destroyed
+	std::vector<SolarSystem*> retired;
+
+	void run(void);
+public:
+	DestinationBuilder(const SystemGenerator* generator, Catalog* catalog, const std::vector<TextureHandle>& catalogTextures);
+	~DestinationBuilder(void);
+
+	// start building the system, unless one is already built or being built
+	void prepare(uint64_t id);
+
+	// the finished destination if there is one, it still belongs to the builder
+	SolarSystem* peek(void);
+
+	// take the system, waiting for it if it's still being built, and building it right away if it wasn't prepared
+	SolarSystem* take(uint64_t id);
+
+	// destroy a system on the background thread
+	void retire(SolarSystem* system);
+
+	// the id of the system a wormhole of the system leads to, picked by the seed
+	uint64_t destination(uint64_t from, uint64_t seed);
+
+	// the id of a generated system picked by the seed, never one of the catalog
+	uint64_t generatedId(uint64_t seed);
+
+	// build the system with the id, may be called on any thread
+	SolarSystem* build(uint64_t id);
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef SWM_FLIGHTPLAN_H
+#define SWM_FLIGHTPLAN_H
+
+#include <vector>
+#include "solarsystem.h"
+#include "jobsystem.h"
+
+/*
+ * This class flies scripted flight plans through a solar system without drawing anything.
+ * Time is stepped on one grid for all plans: the bodies are moved once per step, and then all plans
+ * are checked against them on all cores with the same distances the game checks the camera with.
+ * A plan stops at its first contact with a planet or moon, as the spaceship would, but it flies on
+ * through wormholes, which are counted. Contacts are found to within one step.
+ * A plan may also be given a planet to fly to, and then it stops once it's close enough to it.
+ * The steps may be taken all at once, or a few at a time to spread the work over several frames.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+// where the spaceship is and where it looks at a time in days, the ship flies straight between points
+struct FlightPoint
+{
+	double time;
+	float position[3];
+	float forward[3];
+	float up[3];
+};
+
+// the points of a plan go forward in time
+struct FlightPlan
+{
+	std::vector<FlightPoint> points;
+};
+
+struct FlightReport
+{
+	// the time of the first contact with a planet or moon, -1 if there was none
+	double contactTime;
+
+	// the smallest distance to the surface of a planet or moon and when it was
+	float minClearance;
+	double minClearanceTime;
+
+	// the time the plan got close enough to the target, -1 if it never did or there is no target
+	double arrivalTime;
+
+	// times the plan went into a wormhole, and the first time it did, -1 if it never did
+	int wormholeEntries;
+	double firstWormholeTime;
+};
+
+class FlightEvaluator
+{
+private:
+	SolarSystem* system;
+	JobSystem* jobs;
+	double step;
+
+	// plans are handed to the threads this many at a time
+	int grain;
+
+	// the planet the plans fly to, -1 for none, and how close to its surface they arrive
+	int target;
+	float arrival;
+
+	// the plans being evaluated, and for each the point it has got to and whether it's in a wormhole
+	const std::vector<FlightPlan>* plans;
+	std::vector<FlightReport>* reports;
+	std::vector<int> cursors;
+	std::vector<char> inWormhole;
+	double now;
+
+	// the time covered by the plans and the steps through it, the last one lands on the end
+	double startTime, endTime;
+	int stepCount;
+	int stepsDone;
+
+	static void evaluatePlans(void* data, int begin, int end);
+public:
+	// the system is moved as the plans are evaluated, so it must not be one that is drawn
+	// jobs may be NULL to evaluate the plans on the calling thread
+	FlightEvaluator(SolarSystem* system, JobSystem* jobs, double step);
+
+	// the time between the steps of the system in days
+	void setStep(double step);
+
+	// stop the plans once they are this close to the surface of the planet, -1 for no target
+	void setTarget(int planet, float arrival);
+
+	// 1 spreads a few plans in crowded systems over all cores, more saves handing out many cheap ones
+	void setGrain(int grain);
+
+	// evaluate every plan from the earliest point of any plan to the latest, one report for each plan
+	void evaluate(const std::vector<FlightPlan>& plans, std::vector<FlightReport>& reports);
+
+	// the same in parts: begin, then advance until it returns true, and only then are the reports done
+	// the plans and reports must be kept until then
+	void begin(const std::vector<FlightPlan>& plans, std::vector<FlightReport>& reports);
+	bool advance(int steps);
+	int getStepCount(void);
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef SWM_GLCOUNT_H
+#define SWM_GLCOUNT_H
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+#include <glut.h>
+#include <stdint.h>
+
+/*
+ * A thin layer over OpenGL that counts the calls the performance test has budgets for.
+ * Files that draw include it after everything else, and the macros below count every call
+ * on its way to the driver. Calls through the pointers of glExtensions are counted where they're made.
+ * Only the thread of OpenGL draws, so the counts are plain numbers.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+struct GLCallCounts
+{
+	// glBegin and every kind of glDrawArrays, a sphere of GLU counts once for each of its stacks
+	int64_t drawCalls;
+	int64_t textureBinds;
+
+	// switches of the fixed-function state
+	int64_t stateChanges;
+};
+
+extern GLCallCounts glCalls;
+
+#define glBegin(mode) (glCalls.drawCalls++, glBegin(mode))
+#define glDrawArrays(mode, first, count) (glCalls.drawCalls++, glDrawArrays(mode, first, count))
+#define gluSphere(quadric, radius, slices, stacks) (glCalls.drawCalls += (stacks), gluSphere(quadric, radius, slices, stacks))
+#define glBindTexture(target, texture) (glCalls.textureBinds++, glBindTexture(target, texture))
+#define glEnable(capability) (glCalls.stateChanges++, glEnable(capability))
+#define glDisable(capability) (glCalls.stateChanges++, glDisable(capability))
+#define glBlendFunc(source, destination) (glCalls.stateChanges++, glBlendFunc(source, destination))
+#define glDepthMask(flag) (glCalls.stateChanges++, glDepthMask(flag))
+#define glTexEnvi(target, name, value) (glCalls.stateChanges++, glTexEnvi(target, name, value))
+#define glPushAttrib(mask) (glCalls.stateChanges++, glPushAttrib(mask))
+#define glPopAttrib() (glCalls.stateChanges++, glPopAttrib())
+
+#endif
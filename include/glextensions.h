@@ -0,0 +1,150 @@
+#ifndef SWM_GLEXTENSIONS_H
+#define SWM_GLEXTENSIONS_H
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+#include <gl\GL.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The parts of OpenGL past 1.1 the game uses when the driver has them.
+ * The headers of Windows stop at 1.1, so the entry points are looked up once a context exists,
+ * and the flags tell which groups of them were found. Everything works without them, only slower.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+#ifndef GL_VERSION_1_5
+typedef ptrdiff_t GLsizeiptr;
+typedef ptrdiff_t GLintptr;
+#endif
+
+#ifndef GL_VERSION_3_2
+typedef struct __GLsync* GLsync;
+typedef uint64_t GLuint64;
+typedef int64_t GLint64;
+#endif
+
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER 0x8892
+#endif
+#ifndef GL_STATIC_DRAW
+#define GL_STATIC_DRAW 0x88E4
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+#ifndef GL_DYNAMIC_DRAW
+#define GL_DYNAMIC_DRAW 0x88E8
+#endif
+#ifndef GL_WRITE_ONLY
+#define GL_WRITE_ONLY 0x88B9
+#endif
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+#ifndef GL_TIMEOUT_EXPIRED
+#define GL_TIMEOUT_EXPIRED 0x911B
+#endif
+#ifndef GL_WAIT_FAILED
+#define GL_WAIT_FAILED 0x911D
+#endif
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+#ifndef GL_TIMESTAMP
+#define GL_TIMESTAMP 0x8E28
+#endif
+#ifndef GL_FRAMEBUFFER
+#define GL_FRAMEBUFFER 0x8D40
+#endif
+#ifndef GL_RENDERBUFFER
+#define GL_RENDERBUFFER 0x8D41
+#endif
+#ifndef GL_COLOR_ATTACHMENT0
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#endif
+#ifndef GL_DEPTH_ATTACHMENT
+#define GL_DEPTH_ATTACHMENT 0x8D00
+#endif
+#ifndef GL_FRAMEBUFFER_COMPLETE
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#endif
+#ifndef GL_MAX_RENDERBUFFER_SIZE
+#define GL_MAX_RENDERBUFFER_SIZE 0x84E8
+#endif
+#ifndef GL_DEPTH_COMPONENT24
+#define GL_DEPTH_COMPONENT24 0x81A6
+#endif
+
+struct GLExtensions
+{
+	// buffer objects, OpenGL 1.5
+	bool buffers;
+	void (APIENTRY* genBuffers)(GLsizei count, GLuint* buffers);
+	void (APIENTRY* deleteBuffers)(GLsizei count, const GLuint* buffers);
+	void (APIENTRY* bindBuffer)(GLenum target, GLuint buffer);
+	void (APIENTRY* bufferData)(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+	void* (APIENTRY* mapBuffer)(GLenum target, GLenum access);
+	GLboolean (APIENTRY* unmapBuffer)(GLenum target);
+
+	// many ranges of vertices in one call, OpenGL 1.4
+	bool multiDraw;
+	void (APIENTRY* multiDrawArrays)(GLenum mode, const GLint* first, const GLsizei* count, GLsizei drawCount);
+
+	// buffers that stay mapped while they are drawn from, with fences to know when, OpenGL 4.4
+	bool persistentBuffers;
+	void (APIENTRY* bufferStorage)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+	void* (APIENTRY* mapBufferRange)(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+	GLsync (APIENTRY* fenceSync)(GLenum condition, GLbitfield flags);
+	GLenum (APIENTRY* clientWaitSync)(GLsync sync, GLbitfield flags, GLuint64 timeout);
+	void (APIENTRY* deleteSync)(GLsync sync);
+
+	// the time the card reaches a point of the commands, OpenGL 3.3
+	bool timerQueries;
+	void (APIENTRY* genQueries)(GLsizei count, GLuint* queries);
+	void (APIENTRY* deleteQueries)(GLsizei count, const GLuint* queries);
+	void (APIENTRY* queryCounter)(GLuint query, GLenum target);
+	void (APIENTRY* getQueryObjectiv)(GLuint query, GLenum name, GLint* value);
+	void (APIENTRY* getQueryObjectui64v)(GLuint query, GLenum name, GLuint64* value);
+	void (APIENTRY* getInteger64v)(GLenum name, GLint64* value);
+
+	// drawing into images other than the window, OpenGL 3.0
+	bool framebuffers;
+	void (APIENTRY* genFramebuffers)(GLsizei count, GLuint* framebuffers);
+	void (APIENTRY* deleteFramebuffers)(GLsizei count, const GLuint* framebuffers);
+	void (APIENTRY* bindFramebuffer)(GLenum target, GLuint framebuffer);
+	GLenum (APIENTRY* checkFramebufferStatus)(GLenum target);
+	void (APIENTRY* genRenderbuffers)(GLsizei count, GLuint* renderbuffers);
+	void (APIENTRY* deleteRenderbuffers)(GLsizei count, const GLuint* renderbuffers);
+	void (APIENTRY* bindRenderbuffer)(GLenum target, GLuint renderbuffer);
+	void (APIENTRY* renderbufferStorage)(GLenum target, GLenum format, GLsizei width, GLsizei height);
+	void (APIENTRY* framebufferRenderbuffer)(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer);
+};
+
+extern GLExtensions glExtensions;
+
+// look up the entry points, the context must be current
+void loadGLExtensions(void);
+
+#endif
@@ -5,4 +5,12 @@
 const float distanceScale = 0.00000001f;
 extern float planetSizeScale;
 
-#endif
\ No newline at end of file
+// the spaceship crashes into a body or falls into a wormhole this close to its surface
+const float contactDistance = 0.001f;
+
+// the perspective projection used for the scene
+const float fieldOfView = 70.0f;
+const float nearPlane = 0.001f;
+const float farPlane = 500.0f;
+
+#endif
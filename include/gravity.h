@@ -0,0 +1,126 @@
+#ifndef SWM_GRAVITY_H
+#define SWM_GRAVITY_H
+
+#include <vector>
+#include <stdint.h>
+#include "jobsystem.h"
+
+/*
+ * A body as the gravity simulation sees it.
+ * The mass is the gravitational parameter, G times the mass, so G never shows up.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+struct GravityBody
+{
+	double position[3];
+	double velocity[3];
+	double mass;
+};
+
+/*
+ * This class integrates the mutual gravity of many bodies.
+ * Every step the bodies are sorted into an octree and far away groups of bodies pull like a
+ * single body at their center of mass (Barnes-Hut). Nearby bodies walk the tree together
+ * and share one list of what pulls them, which is then summed up in tight loops. Theta is the largest ratio of the size of a
+ * group to its distance that is still treated as one, 0 makes every pull exact. The forces are
+ * worked out on all cores and the bodies move with a kick-drift-kick leapfrog, which keeps the
+ * energy from drifting away over long runs.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+class GravitySimulation
+{
+private:
+	struct Node
+	{
+		// the cube the node covers
+		double center[3];
+		double halfSize;
+
+		double mass;
+		double massCenter[3];
+
+		// index of the first of eight children, -1 for a leaf
+		int children;
+
+		// the bodies of a leaf are order[first] to order[first + count - 1]
+		int first;
+		int count;
+	};
+
+	JobSystem* jobs;
+	float theta;
+
+	// added to the squared distance so close passes don't blow up
+	double softening;
+
+	// the bodies, one array per component
+	std::vector<double> x, y, z;
+	std::vector<double> vx, vy, vz;
+	std::vector<double> ax, ay, az;
+	std::vector<double> mass;
+	bool accelerated;
+
+	// the tree, and the bodies sorted so that those of a leaf are next to each other
+	std::vector<Node> nodes;
+	std::vector<int> order;
+	std::vector<int> scratch;
+
+	// nodes whose bodies walk the tree together
+	std::vector<int> groups;
+
+	// the potential energy of every body with those after it
+	std::vector<double> potentials;
+
+	void buildTree(void);
+	void buildNode(int index, int first, int count, int depth, bool grouped);
+	void finishLeaf(Node& node);
+	// work out the accelerations of the bodies of the groups from begin to end
+	void accelerateRange(int begin, int end);
+	void accelerateExactRange(int begin, int end);
+
+	// the pull of a list of bodies on a body, the list is a whole number of blocks of four
+	void pullOf(float bx, float by, float bz, const std::vector<float>& px, const std::vector<float>& py,
+		const std::vector<float>& pz, const std::vector<float>& pm, float* sum);
+	static void accelerateTask(void* data, int begin, int end);
+	static void accelerateExactTask(void* data, int begin, int end);
+	static void potentialTask(void* data, int begin, int end);
+	void runParallel(RangeFunction function, int count, int grain);
+public:
+	// without a job system the work is done on the calling thread
+	GravitySimulation(JobSystem* jobs);
+
+	void clear(void);
+	int add(const GravityBody& body);
+	int getBodyCount(void);
+	void getBody(int index, GravityBody* body);
+	// the accelerations are not worked out again, the moved body feels the pull of its old place for half a step
+	void setPosition(int index, const double* position);
+	void setVelocity(int index, const double* velocity);
+
+	void setTheta(float theta);
+	float getTheta(void);
+	void setSoftening(double softening);
+
+	// add bodies on circular orbits in a thin ring around a mass at the origin
+	void addRing(int count, double inner, double outer, double centralMass, double totalMass, uint64_t seed);
+
+	// take away the motion of the center of mass, so the system stays where it is
+	void removeDrift(void);
+
+	// work out the accelerations of all bodies, with the tree or exactly
+	void accelerate(bool exact);
+	void getAcceleration(int index, double* acceleration);
+
+	// move all bodies forward by dt
+	void step(double dt);
+
+	// kinetic plus potential energy, worked out exactly
+	double getEnergy(void);
+
+	// positions of a range of bodies as floats, three to a body
+	void getPositions(int first, int count, std::vector<float>& positions);
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef SWM_INPUTLOG_H
+#define SWM_INPUTLOG_H
+
+#include <vector>
+#include <stdint.h>
+
+/*
+ * These functions record and replay the input of a run.
+ * A log is a header, the state the run started from and the events in the order they came in.
+ * Every event is stamped with the frame it's handled in, so a replay feeds it to the same frame
+ * and flies exactly the same way no matter how long the frames take.
+ */
+
+const uint32_t inputLogVersion = 1;
+
+enum InputEventType
+{
+	INPUT_KEY_DOWN,
+	INPUT_KEY_UP,
+	INPUT_MOUSE
+};
+
+struct InputEvent
+{
+	uint32_t frame;
+	uint8_t type;
+	uint8_t key;
+
+	// the position of the mouse in the window
+	int16_t x;
+	int16_t y;
+	uint16_t reserved;
+};
+
+// everything the flight depends on besides the input
+struct InputStart
+{
+	double time;
+	double timeSpeed;
+
+	// the id of the first system, also the seed it was generated from
+	uint64_t systemId;
+	uint64_t universeSeed;
+	int32_t universeMode;
+	int32_t gravityMode;
+	int32_t asteroidCount;
+	float gravityTheta;
+};
+
+struct InputLog
+{
+	InputStart start;
+	std::vector<InputEvent> events;
+
+	// frames the run took, a replay goes on until then even after the last event
+	uint32_t frameCount;
+};
+
+// write the log to the file, return false if it can't be written
+bool writeInputLog(const char* path, const InputLog& log);
+
+// validate a log and read it, the log is untouched if the file is broken
+bool readInputLog(const char* path, InputLog* log);
+
+#endif
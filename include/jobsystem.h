@@ -0,0 +1,129 @@
+#ifndef SWM_JOBSYSTEM_H
+#define SWM_JOBSYSTEM_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+/*
+ * This class spreads the work of a frame over all cores.
+ * Every thread has its own queue of tasks. It takes new tasks from the back of its own queue
+ * and steals old ones from the front of the others' when it runs out. The thread that waits
+ * for some work to finish runs tasks too, so nested waits never block a core.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+// runs the items from begin to end of a range
+typedef void (*RangeFunction)(void* data, int begin, int end);
+
+// runs a single job of a graph
+typedef void (*JobFunction)(void* data);
+
+class JobSystem
+{
+private:
+	struct Task
+	{
+		RangeFunction function;
+		void* data;
+		int begin;
+		int end;
+
+		// counted down when the task is done
+		std::atomic<int>* remaining;
+	};
+
+	struct Queue
+	{
+		std::mutex lock;
+		std::deque<Task> tasks;
+
+		// nanoseconds spent running tasks
+		std::atomic<int64_t> busy;
+	};
+
+	// queue 0 belongs to the threads that are not workers, the main thread among them
+	std::vector<Queue*> queues;
+	std::vector<std::thread> workers;
+
+	// wakes sleeping workers when tasks are pushed, and waiting threads when tasks are pushed or done
+	std::mutex sleepLock;
+	std::condition_variable wake;
+	std::condition_variable finished;
+	std::atomic<int> queued;
+	bool stopping;
+
+	// the time and the busy times utilization was last measured at
+	std::chrono::steady_clock::time_point measured;
+	std::vector<int64_t> lastBusy;
+
+	void run(int index);
+	int currentQueue(void);
+
+	// run one task from the own queue or stolen from another, return false if there was none
+	bool runOne(int index);
+	void execute(int index, Task& task);
+public:
+	// use one worker less than there are cores by default, the main thread makes up for it
+	JobSystem(int threadCount = 0);
+	~JobSystem(void);
+
+	// the main thread counts as one
+	int getThreadCount(void);
+
+	// push a task, it's run by some thread and counts remaining down when done
+	void push(RangeFunction function, void* data, int begin, int end, std::atomic<int>* remaining);
+
+	// run tasks until remaining reaches zero, sleep while other threads run the last of them
+	void wait(std::atomic<int>* remaining);
+
+	// split the range into pieces of at least grain items and run them on all threads
+	void parallelFor(int count, int grain, RangeFunction function, void* data);
+
+	// fraction of the time every thread spent running tasks since the last call, the main thread comes first
+	void getUtilization(std::vector<float>& utilization);
+};
+
+/*
+ * This class runs a graph of jobs, a job starts once all jobs it depends on are done.
+ * Jobs are added with the jobs they depend on, so the graph is always in topological order.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+class JobGraph
+{
+private:
+	struct Node
+	{
+		JobFunction function;
+		void* data;
+
+		// jobs not yet done that this one waits for
+		std::atomic<int> waiting;
+		std::vector<int> dependants;
+	};
+
+	JobSystem* jobs;
+	std::vector<Node*> nodes;
+	std::atomic<int> remaining;
+
+	// called for every node by the job system
+	static void runNode(void* data, int begin, int end);
+public:
+	// without a job system the jobs run in order on the calling thread
+	JobGraph(JobSystem* jobs);
+	~JobGraph(void);
+
+	// return the index of the job, dependencies are indices of earlier jobs, -1 for none
+	int add(JobFunction function, void* data, int dependency = -1, int otherDependency = -1);
+
+	// run all jobs and wait for them
+	void run(void);
+};
+
+#endif
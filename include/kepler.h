@@ -0,0 +1,56 @@
+#ifndef SWM_KEPLER_H
+#define SWM_KEPLER_H
+
+#include <cstddef>
+#include <vector>
+
+const float pi = 3.14159265f;
+
+/*
+ * This class solves Kepler's equation, M = E - e sin E, for the orbits of many bodies at once.
+ * The mean anomaly M grows evenly with time, the eccentric anomaly E places the body on its ellipse.
+ * Four orbits are solved together with Newton's method for a fixed number of steps. Each solve
+ * starts from where the last one ended, moved on by the change of M, so two steps are enough
+ * from frame to frame. Orbits that are new or jumped far take the longer way from a safe guess.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+class KeplerSolver
+{
+private:
+	// the arrays are padded to whole blocks of four with circles
+	int count;
+	std::vector<float> eccentricities;
+
+	// the mean and eccentric anomalies of the last solve, where the next one starts
+	std::vector<float> lastMean;
+	std::vector<float> lastEccentric;
+
+	// for every block of four, whether its last solve is a good place to start
+	std::vector<bool> solved;
+
+	void solveBlock(int block);
+public:
+	// set the mean anomalies in radians before solving, any angle will do
+	std::vector<float> meanAnomalies;
+
+	// the sine and cosine of the eccentric anomalies that were found
+	std::vector<float> sines;
+	std::vector<float> cosines;
+
+	KeplerSolver(void);
+
+	// return the index of the orbit
+	int add(float eccentricity);
+	void reserve(int count);
+	int size(void) const;
+
+	// the next solve starts every orbit from scratch
+	void reset(void);
+	void solve(void);
+
+	// bytes taken by the arrays
+	size_t getMemoryFootprint(void) const;
+};
+
+#endif
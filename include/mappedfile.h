@@ -0,0 +1,39 @@
+#ifndef SWM_MAPPEDFILE_H
+#define SWM_MAPPEDFILE_H
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+#include <cstddef>
+
+/*
+ * This class maps a whole file into memory for reading.
+ * Files are read in place, so nothing is copied or parsed when they are opened.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+class MappedFile
+{
+private:
+	const unsigned char* data;
+	size_t size;
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE mapping;
+#else
+	int file;
+#endif
+
+	// the mapping can't be shared
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+public:
+	MappedFile(void);
+	~MappedFile(void);
+	bool open(const char* path);
+	void close(void);
+	const unsigned char* getData(void);
+	size_t getSize(void);
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef SWM_METRICS_H
+#define SWM_METRICS_H
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+
+/*
+ * These classes count what the game does, so it can be watched from outside while it runs.
+ * Counters only go up, gauges hold the latest value and histograms count values into buckets.
+ * All of them may be changed from any thread without locks.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+class Counter
+{
+private:
+	std::atomic<int64_t> value;
+public:
+	Counter(void);
+	void add(int64_t amount = 1);
+	int64_t get(void);
+};
+
+class Gauge
+{
+private:
+	std::atomic<double> value;
+public:
+	Gauge(void);
+	void set(double value);
+	void add(double amount);
+	double get(void);
+};
+
+class Histogram
+{
+private:
+	static const int maxBuckets = 16;
+
+	// upper bounds of the buckets, values above the last one go to an extra bucket
+	double bounds[maxBuckets];
+	int bucketCount;
+	std::atomic<int64_t> counts[maxBuckets + 1];
+	std::atomic<int64_t> count;
+	Gauge sum;
+public:
+	Histogram(const double* bounds, int bucketCount);
+	void observe(double value);
+	int getBucketCount(void);
+	double getBound(int bucket);
+
+	// values up to the bound of the bucket, the extra bucket takes all of them
+	int64_t getCumulativeCount(int bucket);
+	int64_t getCount(void);
+	double getSum(void);
+};
+
+// the metrics of the game
+extern Counter framesRendered;
+extern Histogram frameSeconds;
+extern Gauge frameSecondsMedian;
+extern Gauge frameSecondsP99;
+extern Counter drawCalls;
+extern Counter textureBinds;
+extern Counter verticesSubmitted;
+extern Counter bytesUploaded;
+extern Gauge textureMemory;
+extern Gauge bodyCount;
+extern Counter wormholeJumps;
+
+// all metrics in the text format of Prometheus
+void formatMetrics(std::string& text);
+
+// replace the file at the path with the metrics, readers never see half of them
+bool writeMetrics(const char* path);
+
+#endif
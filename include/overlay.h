@@ -0,0 +1,58 @@
+#ifndef SWM_OVERLAY_H
+#define SWM_OVERLAY_H
+
+#include <vector>
+#include "glextensions.h"
+
+/*
+ * This class draws text and graphs over the screen, in the coordinates of the window with y pointing down.
+ * The letters come from a small font built into the program, packed into one texture with a solid
+ * block for the graphs, so everything written in a frame is collected into one vertex buffer
+ * and drawn with a single call.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+class Overlay
+{
+private:
+	struct Vertex
+	{
+		float position[2];
+		float coordinates[2];
+		unsigned char color[4];
+	};
+
+	// every letter is scale times its size in pixels
+	float scale;
+	GLuint atlas;
+	GLuint buffer;
+	bool created;
+	std::vector<Vertex> vertices;
+
+	void createObjects(void);
+	void quad(float left, float top, float right, float bottom, float s0, float t0, float s1, float t1, const unsigned char* color);
+public:
+	// width and height of a letter with its spacing, at scale 1
+	static const int letterWidth = 6;
+	static const int letterHeight = 9;
+
+	Overlay(float scale);
+	~Overlay(void);
+
+	// start collecting a new frame
+	void clear(void);
+
+	// write a line with its top left corner at x, y, lowercase letters are written in uppercase
+	void print(float x, float y, const unsigned char* color, const char* format, ...);
+	void rect(float x, float y, float width, float height, const unsigned char* color);
+
+	// bars of the values from the oldest to the newest, a bar of maxValue fills the height,
+	// values from warning on are drawn in the warning color
+	void graph(float x, float y, float width, float height, const float* values, int count, float maxValue,
+		float warning, const unsigned char* color, const unsigned char* warningColor);
+
+	// draw everything collected, the projection must map the window
+	void render(void);
+};
+
+#endif
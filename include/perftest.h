@@ -0,0 +1,80 @@
+#ifndef SWM_PERFTEST_H
+#define SWM_PERFTEST_H
+
+#include <vector>
+#include <stdint.h>
+#include "profiler.h"
+
+/*
+ * This class checks that canned scenes stay within their budgets.
+ * The main program flies to every scene and renders it headlessly, and for each measured frame
+ * this class takes the calls of OpenGL, the allocations and the time of the phases of the profiler.
+ * Counts are held to their budgets in the worst frame and times in the median frame, which is steadier.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+const int maxPhaseBudgets = 4;
+
+struct PhaseBudget
+{
+	// the name of a phase of the profiler, NULL for none
+	const char* phase;
+	float milliseconds;
+};
+
+struct PerfScene
+{
+	const char* name;
+
+	// the system and the asteroids of gravity mode, none for fixed orbits
+	uint64_t systemId;
+	int asteroids;
+
+	// budgets per frame
+	int64_t drawCalls;
+	int64_t textureBinds;
+	int64_t stateChanges;
+	int64_t allocations;
+	PhaseBudget phases[maxPhaseBudgets];
+};
+
+class PerfTest
+{
+private:
+	Profiler* profiler;
+	int scene;
+
+	// where the counts were at the start of the frame
+	int64_t startDrawCalls;
+	int64_t startTextureBinds;
+	int64_t startStateChanges;
+	int64_t startAllocations;
+	uint64_t startEvent;
+
+	// the measurements of every frame of the scene
+	std::vector<int64_t> drawCalls;
+	std::vector<int64_t> textureBinds;
+	std::vector<int64_t> stateChanges;
+	std::vector<int64_t> allocations;
+	std::vector<float> phaseTimes[maxPhaseBudgets];
+
+	// print one line of the report, return false if the value is over its budget
+	bool compare(const char* what, double value, double budget, const char* format);
+public:
+	PerfTest(Profiler* profiler);
+	static int getSceneCount(void);
+	static const PerfScene& getScene(int index);
+
+	// forget the frames of the last scene
+	void beginScene(int index);
+	void beginFrame(void);
+	void endFrame(void);
+
+	// print the measurements next to the budgets, return false if any of them is over
+	bool report(void);
+};
+
+// allocations made with new since the program started, -1 unless built with SWM_COUNT_ALLOCATIONS
+int64_t getAllocationCount(void);
+
+#endif
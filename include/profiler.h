@@ -0,0 +1,125 @@
+#ifndef SWM_PROFILER_H
+#define SWM_PROFILER_H
+
+#include <atomic>
+#include <stdint.h>
+#include "glextensions.h"
+
+/*
+ * This class records how long the phases of the frames take, on every thread and on the card.
+ * Phases are written into one ring of the latest events without locks, a thread claims a slot by
+ * counting up the next index and marks it written with its sequence, so the oldest events are
+ * overwritten and a slot being written while the trace is saved is skipped.
+ * Phases on the card are measured with timestamp queries that are read a few frames later,
+ * so the program never waits for the card, and they are moved onto the clock of the processor.
+ * The trace is written in the format of Chrome's trace viewer, chrome://tracing or Perfetto.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+class Profiler
+{
+private:
+	struct Event
+	{
+		// names are kept as pointers, so they must be string literals
+		const char* name;
+		int64_t start;
+		int64_t duration;
+		int track;
+	};
+
+	struct Slot
+	{
+		// index of the event plus one once it's written, 0 while it's being written
+		std::atomic<uint64_t> sequence;
+		Event event;
+	};
+
+	// the track of the card comes first, then one for every thread that records
+	static const int gpuTrack = 0;
+	static const int maxTracks = 64;
+
+	// frames the queries of the card are read behind, and queries of a frame at most
+	static const int gpuFrameCount = 4;
+	static const int maxGpuScopes = 16;
+
+	struct GpuScope
+	{
+		const char* name;
+		GLuint queries[2];
+	};
+
+	struct GpuFrame
+	{
+		GpuScope scopes[maxGpuScopes];
+		int count;
+	};
+
+	Slot* slots;
+	uint64_t capacity;
+	std::atomic<uint64_t> next;
+	std::atomic<const char*> trackNames[maxTracks];
+
+	// only touched on the thread of OpenGL
+	bool gpuReady;
+	GpuFrame gpuFrames[gpuFrameCount];
+	int gpuFrame;
+
+	// the clock of the processor minus the clock of the card, in nanoseconds
+	int64_t gpuOffset;
+
+	int currentTrack(void);
+	void push(const char* name, int64_t start, int64_t duration, int track);
+	void collectGpu(GpuFrame& frame);
+public:
+	// keep the latest events, the capacity is rounded up to a power of two
+	Profiler(int capacity);
+	~Profiler(void);
+
+	// nanoseconds on a steady clock
+	static int64_t now(void);
+
+	// record a phase of the calling thread
+	void record(const char* name, int64_t start, int64_t duration);
+
+	// name the track of the calling thread in the trace
+	void nameThread(const char* name);
+
+	// start the next frame on the card, reading the queries of an old one, only on the thread of OpenGL
+	void beginFrame(void);
+
+	// mark the start and the end of a phase on the card, only on the thread of OpenGL
+	// return -1 if it can't be measured
+	int beginGpu(const char* name);
+	void endGpu(int scope);
+
+	// events recorded so far, the latest of them can be read back by their index
+	uint64_t getEventCount(void);
+
+	// read back an event, return false if it was overwritten or is being written
+	bool getEvent(uint64_t index, const char** name, int64_t* duration, bool* gpu);
+
+	// write the events kept so far as a trace, return false if the file can't be written
+	bool writeTrace(const char* path);
+};
+
+/*
+ * This class records the time from its construction to its destruction as a phase,
+ * and with gpu set, also the time the card takes for the commands in between.
+ * Nothing is recorded without a profiler.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+class ProfileScope
+{
+private:
+	Profiler* profiler;
+	const char* name;
+	int64_t start;
+	int gpuScope;
+public:
+	ProfileScope(Profiler* profiler, const char* name, bool gpu = false);
+	~ProfileScope(void);
+};
+
+#endif
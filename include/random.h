@@ -0,0 +1,51 @@
+#ifndef SWM_RANDOM_H
+#define SWM_RANDOM_H
+
+#include <stdint.h>
+
+/*
+ * This class is a small and fast pseudo random number generator (SplitMix64).
+ * Every generator has its own state, so the same seed always gives the same numbers,
+ * whichever thread it runs on.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+class Random
+{
+private:
+	uint64_t state;
+public:
+	Random(uint64_t seed)
+	{
+		state = seed;
+	}
+
+	uint64_t next(void)
+	{
+		uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	// a uniform integer in [0, n)
+	int range(int n)
+	{
+		return (int)(((next() >> 32) * (uint64_t)n) >> 32);
+	}
+
+	// a uniform float in [low, high)
+	float uniform(float low, float high)
+	{
+		return low + (high - low) * (float)((next() >> 40) * (1.0 / 16777216.0));
+	}
+
+	// mix two values into a seed
+	static uint64_t combine(uint64_t a, uint64_t b)
+	{
+		Random random(a ^ (b * 0x9E3779B97F4A7C15ull));
+		return random.next();
+	}
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef SWM_SAVEGAME_H
+#define SWM_SAVEGAME_H
+
+#include <vector>
+#include <stdint.h>
+#include "body.h"
+#include "camera.h"
+
+/*
+ * These functions save and restore the state of the game.
+ * A save is a header, a table of sections and the sections themselves. Each section is an array
+ * of fixed-size records at an 8-byte aligned offset, so a save can be mapped, validated and read
+ * in place. Textures are stored by the names of their images since the handles change between runs.
+ */
+
+const uint32_t saveVersion = 4;
+
+// the state of the simulation besides the bodies and the camera
+struct SaveState
+{
+	double time;
+	double timeSpeed;
+
+	// the id of the system, also the seed it was generated from
+	uint64_t systemId;
+	int32_t planetSelected;
+
+	// the sector of the open universe the camera is in
+	int32_t sector[3];
+};
+
+// the in-memory form of a save, a flat copy of everything needed to restore the game
+struct SaveSnapshot
+{
+	// saves are numbered so the newest of several can be found
+	uint32_t sequence;
+	SaveState state;
+	CameraState camera;
+	std::vector<BodyDesc> bodies;
+
+	// the images of the textures, each named once, and the image of each body, -1 for none
+	std::vector<AssetRecord> assets;
+	std::vector<int32_t> bodyAssets;
+};
+
+// name the textures of the bodies after their images, only on the main thread, which loads the images
+void nameTextures(SaveSnapshot* snapshot);
+
+
+// write a snapshot to the file and flush it to the disk, the old file is only replaced once the new one is complete
+// the textures must have been named already, so this may run on any thread
+bool writeSave(const char* path, const SaveSnapshot& snapshot);
+
+// validate a save and copy it into the snapshot, the snapshot is untouched if the save is broken
+bool readSave(const char* path, SaveSnapshot* snapshot);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef SWM_SIMULATIONTIME_H
+#define SWM_SIMULATIONTIME_H
+
+#include <cmath>
+
+/*
+ * The time of the game in days, kept as whole days and the part of the current day.
+ * A single double loses the small steps of a frame once the days run into the billions,
+ * while whole days stay exact up to 2^53 of them and the part of a day never grows.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+struct SimulationTime
+{
+	double days;
+
+	// from 0 up to but not including 1
+	double fraction;
+
+	SimulationTime(double time = 0.0)
+	{
+		set(time);
+	}
+
+	void set(double time)
+	{
+		days = floor(time);
+		fraction = time - days;
+	}
+
+	void advance(double elapsed)
+	{
+		double whole = floor(elapsed);
+		fraction += elapsed - whole;
+		days += whole;
+		if (fraction >= 1.0)
+		{
+			fraction -= 1.0;
+			days += 1.0;
+		}
+	}
+
+	// as a single double, which is only as exact as a double can be that far out
+	double get(void) const
+	{
+		return days + fraction;
+	}
+
+	// the time from an earlier time to this one, as exact as the difference itself allows
+	double since(const SimulationTime& earlier) const
+	{
+		return (days - earlier.days) + (fraction - earlier.fraction);
+	}
+};
+
+#endif
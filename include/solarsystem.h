@@ -1,45 +1,114 @@
 #ifndef SWM_SOLARSYSTEM_H
 #define SWM_SOLARSYSTEM_H
 
-#ifdef _WIN32
-#include <Windows.h>
-#endif
-#include <gl\GL.h>
 #include <vector>
 
-#include "planet.h"
 #include "camera.h"
-#include "wormhole.h"
+#include "body.h"
+#include "bodystore.h"
+#include "gravity.h"
+#include "simulationtime.h"
+
+/*
+ * The view of the camera, captured once per frame so bodies can be culled on any thread.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+struct RenderView
+{
+	float modelview[16];
+	float projection[16];
+
+	// planes of the view frustum, as (a, b, c, d) with the normals pointing inwards
+	float planes[6][4];
+
+	// read the current matrices of OpenGL
+	void capture(void);
+
+	// the same view for a system whose sun sits at the offset
+	void translate(const float* offset, RenderView* result) const;
+	void updatePlanes(void);
+	bool contains(const float* center, float radius) const;
+};
+
+// a body ready to be drawn
+struct RenderItem
+{
+	float modelview[16];
+	float radius;
+	TextureHandle material;
+	bool unlit;
+};
 
 /*
  * This class makes a solar system for the main program.
+ * Moving and colliding with the bodies is in solarsystem.cpp and needs no OpenGL, drawing them is in solarsystemview.cpp.
  * Note that most of the names of the members are self-explanatory.
  */
 
 class SolarSystem
 {
 private:
-	std::vector<Planet> planets;
-	std::vector<Wormhole> wormholes;
+	BodyStore bodies;
+
+	// the time the bodies were last moved to
+	SimulationTime clock;
+
+	// append the description of one body
+	void describeBody(int index, int parent, std::vector<BodyDesc>& descriptions);
 
 public:
-	SolarSystem();
-	SolarSystem(int mode);
-	void calculatePositions(float time);
-	void addPlanet(float distanceFromSun, float orbitTime, float rotationTime, float radius, GLuint textureHandle);
-	void addWormhole(float distanceFromSun, float orbitTime, float rotationTime, float radius, GLuint textureHandle);
-	void addMoon(int planetIndex, float distanceFromPlanet, float orbitTime, float rotationTime, float radius, GLuint textureHandle);
+	// build a system from the descriptions of its bodies
+	SolarSystem(const std::vector<BodyDesc>& descriptions);
+	// move the bodies and resolve their world transforms
+	void calculatePositions(const SimulationTime& time);
 	void render();
+
+	// collect the visible bodies, this doesn't touch OpenGL and may run on any thread
+	void buildRenderList(const RenderView& view, std::vector<RenderItem>& items);
+
+	// draw the collected bodies on the thread of OpenGL
+	void submit(const std::vector<RenderItem>& items);
 	void renderOrbits();
 	void getPlanetPosition(int index, float* vec);
 	float getRadiusOfPlanet(int index);
 
-	// check the minimum distance with all planets
+	// all bodies in the order they are stored, planets first
+	int getBodyCount(void);
+	void getBodyPosition(int index, float* position);
+
+	// check the minimum distance with all planets and moons
 	float testDistancewithPlanet(Camera camera);
+	float testDistancewithPlanet(const float* position);
 
 	// check the minimum distance with all wormholes
 	float testDistancewithWormhole(Camera camera);
+	float testDistancewithWormhole(const float* position);
+
+	// the distance from a point to the surface of one planet
+	float getDistanceToPlanet(int index, const float* position);
 	bool hasPlanet(unsigned char index);
+
+	// find the nearest body hit by a ray with a normalized direction
+	// return its index and write its center, or return -1 if nothing is hit
+	int pick(const float* origin, const float* direction, float* center);
+
+	// bytes taken by the system and its bodies
+	size_t getMemoryFootprint(void);
+
+	// ask the driver to keep the textures of the system in video memory
+	void makeResident(void);
+
+	// the bodies as free bodies at the time, in the order they are stored
+	// masses follow from the sizes, with the sun heavy enough to keep the innermost planet on its orbit,
+	// and everything starts as fast as its orbit around its parent or the sun goes there
+	void getGravityBodies(const SimulationTime& time, std::vector<GravityBody>& states);
+
+	// move the bodies to where the simulation has them from the index first on, spins still follow the time
+	void placeBodies(GravitySimulation& simulation, int first, const SimulationTime& time);
+
+	// describe all bodies, planets are followed by their moons and wormholes come last
+	void describe(std::vector<BodyDesc>& descriptions);
 };
 
 #endif
\ No newline at end of file
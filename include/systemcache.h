@@ -0,0 +1,52 @@
+#ifndef SWM_SYSTEMCACHE_H
+#define SWM_SYSTEMCACHE_H
+
+#include <list>
+#include <map>
+#include <vector>
+#include <stdint.h>
+#include "solarsystem.h"
+
+/*
+ * This class keeps recently visited solar systems, so going back to one is instant.
+ * Systems are identified by their id, 0 is our own solar system. Once the systems take
+ * more memory than the budget, the least recently visited ones are evicted.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+class SystemCache
+{
+private:
+	struct Entry
+	{
+		uint64_t id;
+		SolarSystem* system;
+		size_t bytes;
+	};
+
+	// the most recently visited system comes first
+	std::list<Entry> entries;
+	std::map<uint64_t, std::list<Entry>::iterator> index;
+	size_t budget;
+	size_t used;
+
+	// evict systems until the cache fits the budget
+	void trim(std::vector<SolarSystem*>& evicted);
+public:
+	SystemCache(size_t budget);
+	~SystemCache(void);
+
+	bool contains(uint64_t id);
+
+	// remove a system from the cache and hand it to the caller, NULL if it isn't cached
+	SolarSystem* take(uint64_t id);
+
+	// keep a system, the cache owns it until it is taken or evicted,
+	// evicted systems are handed back to the caller to be destroyed
+	void put(uint64_t id, SolarSystem* system, std::vector<SolarSystem*>& evicted);
+
+	void setBudget(size_t budget, std::vector<SolarSystem*>& evicted);
+	size_t getUsed(void);
+};
+
+#endif
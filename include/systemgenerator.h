@@ -0,0 +1,39 @@
+#ifndef SWM_SYSTEMGENERATOR_H
+#define SWM_SYSTEMGENERATOR_H
+
+#include <vector>
+#include <stdint.h>
+#include "body.h"
+
+/*
+ * This class generates random solar systems from 64-bit seeds.
+ * The same seed always gives the same system, and every system takes the same small
+ * amount of work, as distances are sampled directly and textures are dealt by shuffling.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+// the images generated systems are made of, in the order their textures are handed to the generator,
+// shared by the game and swmcat so the same seed gets the same images in both
+const int generatedSunCount = 3;
+const char* const generatedSunImages[generatedSunCount] = {"images/sun3.tga", "images/sun1.tga", "images/sun2.tga"};
+const int generatedPlanetCount = 11;
+const char* const generatedPlanetImages[generatedPlanetCount] = {"images/1.tga", "images/2.tga", "images/3.tga",
+	"images/4.tga", "images/5.tga", "images/6.tga", "images/7.tga", "images/8.tga", "images/9.tga", "images/10.tga",
+	"images/11.tga"};
+const char* const generatedWormholeImage = "images/black1.tga";
+
+class SystemGenerator
+{
+private:
+	// the textures generated systems are made of
+	std::vector<TextureHandle> suns;
+	std::vector<TextureHandle> planets;
+	TextureHandle wormhole;
+public:
+	SystemGenerator(const std::vector<TextureHandle>& suns, const std::vector<TextureHandle>& planets, TextureHandle wormhole);
+
+	// describe the system for the seed, planets come out in order of distance from the sun
+	void generate(uint64_t seed, std::vector<BodyDesc>& bodies) const;
+};
+
+#endif
@@ -5,6 +5,17 @@
 #include <Windows.h>
 #endif
 #include <gl\GL.h>
+#include <cstddef>
+#include <vector>
+
+// the pixels of a decoded image, bottom row first with red, green, blue and maybe alpha
+struct TGAImage
+{
+	int width;
+	int height;
+	int bytesPerPixel;
+	std::vector<unsigned char> pixels;
+};
 
 /*
  * This class loads a TGA image from the disk for texture mapping.
@@ -15,9 +26,21 @@ class TGA
 {
 private:
 	GLuint textureHandle;
+
+	// the path the image is loaded from, used as a stable name for the texture
+	char name[64];
 public:
-	TGA(char* imagePath);
+	TGA(const char* imagePath);
 	GLuint getTextureHandle(void);
+	const char* getName(void);
+
+	// look up a loaded image by its name or by its texture handle
+	static TGA* find(const char* name);
+	static TGA* find(GLuint textureHandle);
+
+	// decode an uncompressed or run-length encoded image of 24 or 32 bits from memory without touching OpenGL,
+	// return false if the data isn't such an image or is cut short
+	static bool decode(const unsigned char* data, size_t size, TGAImage* image);
 };
 
 #endif
\ No newline at end of file
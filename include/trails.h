@@ -0,0 +1,87 @@
+#ifndef SWM_TRAILS_H
+#define SWM_TRAILS_H
+
+#include <vector>
+#include <stdint.h>
+#include "glextensions.h"
+
+/*
+ * This class draws fading trails of where things went, each kept in a ring of its latest points.
+ * All trails take a point at the same time, so their newest points sit in the same slot of their
+ * rings and one offset of the texture coordinates fades them all by age, with nothing rewritten.
+ * The rings live in a vertex buffer that stays mapped, in three copies so the copy being written
+ * is never the one the card still draws from, and each copy is only sent the points it missed.
+ * Drivers without such buffers get the points through a buffer mapped every frame, and the oldest
+ * ones draw them straight from memory.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+class TrailSet
+{
+private:
+	enum Mode
+	{
+		MODE_NONE,
+		MODE_PERSISTENT,
+		MODE_MAPPED,
+		MODE_CLIENT
+	};
+
+	static const int copyCount = 3;
+
+	int trailCount;
+	int length;
+
+	// vertices a trail takes, the last one repeats the first to close the ring
+	int stride;
+
+	// the points of all trails one trail after the other, relative to the origin
+	std::vector<float> points;
+	std::vector<int> counts;
+	float origin[3];
+
+	// points taken by every trail so far, the next ones go to slot sample % length
+	uint64_t sample;
+
+	// the rings on the card
+	Mode mode;
+	GLuint vertexBuffer;
+	GLuint coordinateBuffer;
+	GLuint fadeTexture;
+	float* mapped;
+	int copy;
+
+	// the samples each copy holds, and the fences of the frames drawing from it
+	uint64_t synced[copyCount];
+	GLsync fences[copyCount];
+
+	// texture coordinates of the slots, the ranges to draw are collected here every frame
+	std::vector<float> coordinates;
+	std::vector<GLint> firsts[2];
+	std::vector<GLsizei> sizes[2];
+
+	void createObjects(void);
+	// write the points of the samples taken since from into a copy of the rings, return the bytes written
+	size_t copySamples(float* target, uint64_t from);
+	void drawRanges(int index);
+public:
+	// the trails keep the last length points each
+	TrailSet(int trailCount, int length);
+	~TrailSet(void);
+	int getTrailCount(void);
+
+	// forget the points of some trails, they start over with the next sample
+	void clear(int first, int count);
+
+	// set the newest point of a trail, trails in use get one every sample
+	void setPoint(int trail, const float* position);
+	void nextSample(void);
+
+	// move all points that were taken, as the world moves under them
+	void shift(const float* offset);
+
+	// draw the trails in a color that fades away with age
+	void render(const float* color);
+};
+
+#endif
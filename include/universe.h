@@ -0,0 +1,140 @@
+#ifndef SWM_UNIVERSE_H
+#define SWM_UNIVERSE_H
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+#include "solarsystem.h"
+#include "camera.h"
+#include "destinationbuilder.h"
+#include "jobsystem.h"
+
+/*
+ * This class makes an open universe out of a grid of cubic sectors.
+ * Whether a sector holds a solar system, and which one, follows from the seed of the
+ * universe and the coordinates of the sector. Sectors around the camera are built on
+ * worker threads before the spaceship gets there and dropped once it's far away, so the
+ * memory and the work per frame stay the same however far it flies. The camera is kept
+ * within its sector, the origin of the world moves with it from sector to sector.
+ * Drawing the systems is in universeview.cpp, everything else needs no OpenGL.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+// a sector is this many units across, systems are in their centers
+const float sectorSize = 200.0f;
+
+// sectors this far from the camera's are drawn, kept and collided with, counted in sectors along any axis
+const int renderRadius = 2;
+const int pageRadius = 3;
+const int collisionRadius = 1;
+
+class Universe
+{
+private:
+	struct SectorKey
+	{
+		int x, y, z;
+		bool operator<(const SectorKey& other) const;
+	};
+
+	// systems are NULL for empty sectors
+	struct Sector
+	{
+		SectorKey key;
+		SolarSystem* system;
+	};
+
+	DestinationBuilder* builder;
+	uint64_t seed;
+
+	// the sector the camera is in, and the one it's about to move to
+	SectorKey current;
+	SectorKey target;
+	bool prefetching;
+
+	// sectors built so far, those waiting to be built and those being built
+	std::map<SectorKey, Sector> sectors;
+	std::deque<SectorKey> queue;
+	std::map<SectorKey, bool> building;
+	std::vector<Sector> built;
+
+	std::vector<std::thread> workers;
+	std::mutex lock;
+	std::condition_variable wake;
+	bool stopping;
+
+	// a system for empty space
+	SolarSystem* emptySystem;
+
+	// spreads the systems of a frame over the cores, NULL to do them in turn
+	JobSystem* jobs;
+
+	// the systems in range this frame, with where they are and what to draw of them
+	struct Visible
+	{
+		SolarSystem* system;
+		float offset[3];
+		std::vector<RenderItem> items;
+	};
+	std::vector<Visible> visible;
+	int visibleCount;
+	SimulationTime frameTime;
+	RenderView frameView;
+
+	// collect the systems within the radius into visible
+	void gatherVisible(int radius);
+	static void moveSystems(void* data, int begin, int end);
+	static void cullSystems(void* data, int begin, int end);
+
+	void run(void);
+	uint64_t systemId(const SectorKey& key, bool* occupied);
+
+	// whether a sector is close enough to the camera or to the target to be kept
+	bool wanted(const SectorKey& key);
+
+	// queue the missing sectors around the current one and drop those too far away
+	void page(void);
+
+	// take the sectors the workers have built
+	void collect(void);
+
+	// the offset of a sector from the current one
+	void offsetOf(const SectorKey& key, float* offset);
+	static int sectorDistance(const SectorKey& a, const SectorKey& b);
+public:
+	Universe(DestinationBuilder* builder, uint64_t seed, int threadCount, JobSystem* jobs);
+	~Universe(void);
+
+	// move the origin with the camera and page sectors in and out, called once per frame
+	void update(Camera& camera);
+
+	// move to another sector, the camera keeps its place within the sector
+	void moveTo(const int* sector);
+
+	// whether the system of a sector has been built, so moving there shows it at once
+	bool isBuilt(const int* sector);
+
+	// start building the sectors around another sector before moving there
+	void prefetch(const int* sector);
+	void getSector(int* sector);
+
+	// the system of the current sector, an empty system if the sector is empty or not built yet
+	SolarSystem* getCurrentSystem(void);
+
+	void calculatePositions(const SimulationTime& time);
+	void render(void);
+	void renderOrbits(void);
+
+	// check the minimum distance with the bodies of the sectors around the camera
+	float testDistancewithPlanet(Camera& camera);
+	float testDistancewithWormhole(Camera& camera);
+
+	// find the nearest body in sight of the camera and write its center, return false if there is none
+	bool pick(Camera& camera, float* center);
+};
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef SWM_VECMATH_H
+#define SWM_VECMATH_H
+
+#include <cmath>
+
+/*
+ * Small vectors and quaternions by value, for orientations that must not drift.
+ * Everything that needs no square root or sine is constexpr, so constant directions and turns
+ * fold away at compile time. A quaternion turns a vector by q v q*, and q1 * q2 turns by q2 first.
+ * Note that most of the names of the members are self-explanatory.
+ */
+
+struct Vec3
+{
+	float x, y, z;
+};
+
+// w is the real part
+struct Quat
+{
+	float w, x, y, z;
+};
+
+constexpr Vec3 vec3(float x, float y, float z)
+{
+	return Vec3{x, y, z};
+}
+
+constexpr Vec3 operator+(Vec3 a, Vec3 b)
+{
+	return Vec3{a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+constexpr Vec3 operator-(Vec3 a, Vec3 b)
+{
+	return Vec3{a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+constexpr Vec3 operator*(Vec3 a, float s)
+{
+	return Vec3{a.x * s, a.y * s, a.z * s};
+}
+
+constexpr float dot(Vec3 a, Vec3 b)
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+constexpr Vec3 cross(Vec3 a, Vec3 b)
+{
+	return Vec3{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+inline float length(Vec3 a)
+{
+	return sqrtf(dot(a, a));
+}
+
+inline Vec3 normalize(Vec3 a)
+{
+	return a * (1.0f / length(a));
+}
+
+constexpr Quat quat(float w, float x, float y, float z)
+{
+	return Quat{w, x, y, z};
+}
+
+constexpr Quat operator*(Quat a, Quat b)
+{
+	return Quat{a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+		a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+		a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+		a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w};
+}
+
+constexpr Quat conjugate(Quat q)
+{
+	return Quat{q.w, -q.x, -q.y, -q.z};
+}
+
+constexpr float dot(Quat a, Quat b)
+{
+	return a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+// turn v by the unit quaternion q, v + 2 u x (u x v + w v) with u the vector part of q
+constexpr Vec3 rotate(Quat q, Vec3 v)
+{
+	return v + cross(vec3(q.x, q.y, q.z), cross(vec3(q.x, q.y, q.z), v) + v * q.w) * 2.0f;
+}
+
+inline Quat normalize(Quat q)
+{
+	float scale = 1.0f / sqrtf(dot(q, q));
+	return Quat{q.w * scale, q.x * scale, q.y * scale, q.z * scale};
+}
+
+// a turn by angle around the unit axis, counterclockwise looking down the axis
+inline Quat axisAngle(Vec3 axis, float angle)
+{
+	float s = sinf(angle * 0.5f);
+	return Quat{cosf(angle * 0.5f), axis.x * s, axis.y * s, axis.z * s};
+}
+
+// the unit quaternion that turns the x, y and z axes into the given orthonormal axes
+inline Quat fromAxes(Vec3 x, Vec3 y, Vec3 z)
+{
+	// start from the largest component so nothing is divided by a small number
+	float trace = x.x + y.y + z.z;
+	Quat q;
+	if (trace > 0.0f)
+	{
+		float s = 0.5f / sqrtf(trace + 1.0f);
+		q = Quat{0.25f / s, (y.z - z.y) * s, (z.x - x.z) * s, (x.y - y.x) * s};
+	}
+	else if (x.x > y.y && x.x > z.z)
+	{
+		float s = 2.0f * sqrtf(1.0f + x.x - y.y - z.z);
+		q = Quat{(y.z - z.y) / s, 0.25f * s, (y.x + x.y) / s, (z.x + x.z) / s};
+	}
+	else if (y.y > z.z)
+	{
+		float s = 2.0f * sqrtf(1.0f + y.y - x.x - z.z);
+		q = Quat{(z.x - x.z) / s, (y.x + x.y) / s, 0.25f * s, (z.y + y.z) / s};
+	}
+	else
+	{
+		float s = 2.0f * sqrtf(1.0f + z.z - x.x - y.y);
+		q = Quat{(x.y - y.x) / s, (z.x + x.z) / s, (z.y + y.z) / s, 0.25f * s};
+	}
+	return normalize(q);
+}
+
+#endif
@@ -0,0 +1,297 @@
+#include "autopilot.h"
+#include <cmath>
+#include "camera.h"
+
+// frames between plans, the course is flown straight in between
+static const int replanInterval = 15;
+
+// how far ahead a plan looks, and the most frames between two of its samples
+static const int horizonFrames = 240;
+static const int maxSampleFrames = 4;
+
+// distance tests a plan may take per frame, moving a body counts as four and testing a course against it as two
+// candidates are chosen to fill a plan of this many frames, and crowded systems take longer
+static const int planWork = 300000;
+static const int planFrames = replanInterval;
+static const int moveWork = 4;
+static const int minCandidates = 6;
+static const int maxCandidates = 48;
+static const int minSteps = 16;
+
+// the ship has arrived this close to the surface of the target, and keeps this far from everything else
+static const float arrivalClearance = 0.02f;
+static const float safeClearance = 0.005f;
+
+// the widest turn a candidate takes away from the target or the last course, in radians
+static const float maxSpread = 1.2f;
+
+Autopilot::Autopilot(JobSystem* jobs) : random(0x5EED)
+{
+	this->jobs = jobs;
+	system = NULL;
+	shadow = NULL;
+	evaluator = NULL;
+	target = -1;
+	hasHeading = false;
+	framesSincePlan = 0;
+	arrived = false;
+	planning = false;
+	planSteps = 1;
+	planStart = 0.0;
+	planAllowed = 0.0f;
+}
+
+Autopilot::~Autopilot(void)
+{
+	disengage();
+}
+
+bool Autopilot::engage(SolarSystem* system, int planet)
+{
+	disengage();
+
+	// a frame takes at least one step of the straight way
+	if (system->getBodyCount() * (moveWork + 2) > planWork)
+		return false;
+
+	std::vector<BodyDesc> descriptions;
+	system->describe(descriptions);
+	this->system = system;
+	shadow = new SolarSystem(descriptions);
+	evaluator = new FlightEvaluator(shadow, jobs, 1.0);
+	evaluator->setTarget(planet, arrivalClearance);
+	evaluator->setGrain(1);
+	target = planet;
+	hasHeading = false;
+	framesSincePlan = 0;
+	arrived = false;
+	return true;
+}
+
+void Autopilot::disengage(void)
+{
+	delete evaluator;
+	delete shadow;
+	evaluator = NULL;
+	shadow = NULL;
+	system = NULL;
+	target = -1;
+	hasHeading = false;
+	planning = false;
+}
+
+bool Autopilot::isEngaged(void)
+{
+	return system != NULL;
+}
+
+SolarSystem* Autopilot::getSystem(void)
+{
+	return system;
+}
+
+bool Autopilot::hasArrived(void)
+{
+	return arrived;
+}
+
+void Autopilot::predictTarget(const SimulationTime& time, double days, float* position)
+{
+	SimulationTime future = time;
+	future.advance(days);
+	shadow->calculatePositions(future);
+	shadow->getPlanetPosition(target, position);
+}
+
+void Autopilot::addCandidate(const float* position, const float* direction, const SimulationTime& time, double days, float distance)
+{
+	FlightPlan plan;
+	FlightPoint point;
+	for (int i = 0; i < 2; i++)
+	{
+		point.time = time.get() + i * days;
+		for (int j = 0; j < 3; j++)
+		{
+			point.position[j] = position[j] + direction[j] * distance * i;
+			point.forward[j] = direction[j];
+		}
+		vectorSet(point.up, 0.0f, 0.0f, 1.0f);
+		plan.points.push_back(point);
+	}
+	candidates.push_back(plan);
+}
+
+void Autopilot::startPlan(const float* position, const SimulationTime& time, double daysPerFrame, float speed)
+{
+	// a sample never skips over the distance the ship arrives in
+	int sampleFrames = (int)(arrivalClearance * 0.5f / speed);
+	if (sampleFrames < 1)
+		sampleFrames = 1;
+	if (sampleFrames > maxSampleFrames)
+		sampleFrames = maxSampleFrames;
+
+	// as many candidates as the work allows, and a shorter look ahead once there are only a few left
+	int bodies = shadow->getBodyCount();
+	int steps = horizonFrames / sampleFrames;
+	int count = (planWork * planFrames / steps - moveWork * bodies) / (2 * bodies);
+	if (count < minCandidates)
+	{
+		count = minCandidates;
+		steps = planWork * planFrames / (bodies * (moveWork + 2 * minCandidates));
+		if (steps < minSteps)
+			steps = minSteps;
+	}
+	if (count > maxCandidates)
+		count = maxCandidates;
+
+	// a frame takes at least one step, so very crowded systems get as many candidates as fit in one
+	if (bodies * (moveWork + 2 * count) > planWork)
+		count = (planWork / bodies - moveWork) / 2;
+	planSteps = planWork / (bodies * (moveWork + 2 * count));
+
+	int frames = steps * sampleFrames;
+	double frameDays = daysPerFrame > 1e-9 ? daysPerFrame : 1e-9;
+	double days = frames * frameDays;
+	float distance = frames * speed;
+
+	// the ship flies the last course until the plan is done, or holds still before the first one
+	int waitFrames = (steps + planSteps) / planSteps - 1;
+	float start[3];
+	for (int i = 0; i < 3; i++)
+	{
+		start[i] = position[i] + (hasHeading ? heading[i] * speed * waitFrames : 0.0f);
+	}
+	SimulationTime startTime = time;
+	startTime.advance(waitFrames * frameDays);
+	planStart = startTime.get();
+
+	// aim where the target will be by the time the ship gets there
+	float aim[3], direct[3];
+	shadow->calculatePositions(startTime);
+	shadow->getPlanetPosition(target, aim);
+	for (int i = 0; i < 2; i++)
+	{
+		float offset[3] = {aim[0] - start[0], aim[1] - start[1], aim[2] - start[2]};
+		double eta = lengthOfVec(offset) / speed;
+		if (eta > 10.0 * horizonFrames)
+			eta = 10.0 * horizonFrames;
+		predictTarget(startTime, eta * frameDays, aim);
+	}
+	vectorSet(direct, aim[0] - start[0], aim[1] - start[1], aim[2] - start[2]);
+	if (lengthOfVec(direct) < 1e-6f)
+		vectorSet(direct, 0.0f, 0.0f, 1.0f);
+	normalizeVec(direct);
+
+	// a ship that is already too close to something may still move away from it
+	shadow->calculatePositions(startTime);
+	planAllowed = shadow->testDistancewithPlanet(start) * 0.9f;
+	if (planAllowed > safeClearance)
+		planAllowed = safeClearance;
+	predictTarget(startTime, days, planEnd);
+
+	// the straight way and the last course first, then turns away from either, wider and wider
+	candidates.clear();
+	addCandidate(start, direct, startTime, days, distance);
+	if (hasHeading)
+		addCandidate(start, heading, startTime, days, distance);
+	while ((int)candidates.size() < count)
+	{
+		int i = (int)candidates.size();
+		float base[3], side[3], direction[3];
+		vectorCopy(base, hasHeading && i % 2 == 1 ? heading : direct);
+
+		// a random direction square to the base
+		vectorSet(side, random.uniform(-1.0f, 1.0f), random.uniform(-1.0f, 1.0f), random.uniform(-1.0f, 1.0f));
+		float along = side[0] * base[0] + side[1] * base[1] + side[2] * base[2];
+		for (int j = 0; j < 3; j++)
+		{
+			side[j] -= along * base[j];
+		}
+		if (lengthOfVec(side) < 1e-6f)
+			continue;
+		normalizeVec(side);
+
+		float angle = maxSpread * (float)i / count * random.uniform(0.5f, 1.0f);
+		for (int j = 0; j < 3; j++)
+		{
+			direction[j] = base[j] * cos(angle) + side[j] * sin(angle);
+		}
+		addCandidate(start, direction, startTime, days, distance);
+	}
+
+	evaluator->setStep(sampleFrames * frameDays);
+	evaluator->begin(candidates, reports);
+	planning = true;
+}
+
+bool Autopilot::choosePlan(void)
+{
+	// arriving soonest is best, then ending closest to where the target is by then
+	int best = -1;
+	bool bestArrives = false;
+	float bestScore = 0.0f;
+	for (int i = 0; i < candidates.size(); i++)
+	{
+		const FlightReport& report = reports[i];
+		bool arrives = report.arrivalTime >= 0.0;
+		if (report.contactTime >= 0.0 || report.wormholeEntries > 0 || (!arrives && report.minClearance < planAllowed))
+			continue;
+
+		float score;
+		if (arrives)
+		{
+			score = (float)(report.arrivalTime - planStart);
+		}
+		else
+		{
+			const float* last = candidates[i].points.back().position;
+			float offset[3] = {planEnd[0] - last[0], planEnd[1] - last[1], planEnd[2] - last[2]};
+			score = lengthOfVec(offset);
+		}
+		if (best < 0 || (arrives && !bestArrives) || (arrives == bestArrives && score < bestScore))
+		{
+			best = i;
+			bestArrives = arrives;
+			bestScore = score;
+		}
+	}
+	if (best < 0)
+		return false;
+	vectorCopy(heading, candidates[best].points[0].forward);
+	hasHeading = true;
+	return true;
+}
+
+bool Autopilot::fly(const float* position, const SimulationTime& time, double daysPerFrame, float speed, float* direction)
+{
+	arrived = false;
+	if (system == NULL)
+		return false;
+	if (system->getDistanceToPlanet(target, position) < arrivalClearance)
+	{
+		arrived = true;
+		disengage();
+		return false;
+	}
+
+	framesSincePlan++;
+	if (!planning && (!hasHeading || framesSincePlan >= replanInterval))
+	{
+		framesSincePlan = 0;
+		startPlan(position, time, daysPerFrame, speed);
+	}
+	if (planning && evaluator->advance(planSteps))
+	{
+		planning = false;
+		if (!choosePlan())
+		{
+			disengage();
+			return false;
+		}
+	}
+	if (hasHeading)
+		vectorCopy(direction, heading);
+	else
+		vectorSet(direction, 0.0f, 0.0f, 0.0f);
+	return true;
+}
@@ -0,0 +1,126 @@
+#include "autosaver.h"
+#include <cstdio>
+
+AutoSaver::AutoSaver(const char* prefix, int slotCount)
+{
+	this->prefix = prefix;
+	this->slotCount = slotCount > 0 ? slotCount : 1;
+	this->nextSlot = 0;
+	this->sequence = 0;
+	this->stopping = false;
+	this->pending = NULL;
+
+	// carry on after the newest existing save, overwriting the oldest slot first
+	SaveSnapshot snapshot;
+	uint32_t oldest = 0xFFFFFFFFu;
+	for (int i = 0; i < this->slotCount; i++)
+	{
+		if (!readSave(slotPath(i).c_str(), &snapshot))
+		{
+			// an empty slot is used before any existing save
+			if (oldest != 0)
+				nextSlot = i;
+			oldest = 0;
+			continue;
+		}
+		if (snapshot.sequence > sequence)
+			sequence = snapshot.sequence;
+		if (snapshot.sequence < oldest)
+		{
+			oldest = snapshot.sequence;
+			nextSlot = i;
+		}
+	}
+
+	worker = std::thread(&AutoSaver::run, this);
+}
+
+AutoSaver::~AutoSaver(void)
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_one();
+	worker.join();
+
+	delete pending;
+	for (int i = 0; i < spare.size(); i++)
+	{
+		delete spare[i];
+	}
+}
+
+std::string AutoSaver::slotPath(int slot)
+{
+	char name[16];
+	sprintf(name, "%d.dat", slot);
+	return prefix + name;
+}
+
+SaveSnapshot* AutoSaver::begin(void)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	if (spare.empty())
+		return new SaveSnapshot();
+	SaveSnapshot* snapshot = spare.back();
+	spare.pop_back();
+	return snapshot;
+}
+
+void AutoSaver::submit(SaveSnapshot* snapshot)
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		snapshot->sequence = ++sequence;
+
+		// a newer snapshot supersedes one that hasn't been written yet
+		if (pending != NULL)
+			spare.push_back(pending);
+		pending = snapshot;
+	}
+	wake.notify_one();
+}
+
+void AutoSaver::run(void)
+{
+	std::unique_lock<std::mutex> guard(lock);
+	while (true)
+	{
+		while (pending == NULL && !stopping)
+		{
+			wake.wait(guard);
+		}
+		if (pending == NULL)
+			return;
+
+		SaveSnapshot* snapshot = pending;
+		pending = NULL;
+		int slot = nextSlot;
+		nextSlot = (nextSlot + 1) % slotCount;
+
+		// write without holding the lock, so the main thread never waits on the disk
+		guard.unlock();
+		writeSave(slotPath(slot).c_str(), *snapshot);
+		guard.lock();
+
+		spare.push_back(snapshot);
+	}
+}
+
+bool AutoSaver::loadLatest(SaveSnapshot* snapshot)
+{
+	bool found = false;
+	SaveSnapshot candidate;
+	for (int i = 0; i < slotCount; i++)
+	{
+		if (!readSave(slotPath(i).c_str(), &candidate))
+			continue;
+		if (!found || candidate.sequence > snapshot->sequence)
+		{
+			*snapshot = candidate;
+			found = true;
+		}
+	}
+	return found;
+}
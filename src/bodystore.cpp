@@ -0,0 +1,100 @@
+#include "bodystore.h"
+#include <cmath>
+
+BodyStore::BodyStore(void)
+{
+	for (int i = 0; i <= BODY_KIND_COUNT; i++)
+	{
+		first[i] = 0;
+	}
+}
+
+int BodyStore::add(int kind, int parent, float distance, float orbitTime, float rotationTime, float radius, TextureHandle material,
+	const OrbitElements& elements)
+{
+	if (kind < 0 || kind >= BODY_KIND_COUNT || first[kind + 1] != size())
+		return -1;
+
+	int index = size();
+	BodyOrbit orbit;
+	orbit.distance = distance;
+	orbit.orbitTime = orbitTime;
+	orbit.elements = elements;
+	orbit.phase = 0.0;
+
+	// turn the closest point by the periapsis within the orbit, tilt the orbit about the line of
+	// the ascending node and turn that line by its angle, angles go from the y axis towards the x axis
+	float node = elements.ascendingNode * pi / 180.0f;
+	float tilt = elements.inclination * pi / 180.0f;
+	float periapsis = elements.periapsis * pi / 180.0f;
+	float cn = cos(node), sn = sin(node), ci = cos(tilt), si = sin(tilt), cp = cos(periapsis), sp = sin(periapsis);
+	float e = elements.eccentricity;
+	float minorAxis = distance * sqrt(1.0f - e * e);
+	orbit.major[0] = distance * (sn * cp + cn * sp * ci);
+	orbit.major[1] = distance * (cn * cp - sn * sp * ci);
+	orbit.major[2] = distance * sp * si;
+	orbit.minor[0] = minorAxis * (-sn * sp + cn * cp * ci);
+	orbit.minor[1] = minorAxis * (-cn * sp - sn * cp * ci);
+	orbit.minor[2] = minorAxis * cp * si;
+	kepler.add(e);
+	BodySpin spin = {rotationTime, 0.0f, 0.0};
+	BodyPosition position = {0.0f, 0.0f, 0.0f};
+	BodyTransform transform = {{1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}, 0.0f};
+	kinds.push_back(kind);
+	parents.push_back(parent);
+	orbits.push_back(orbit);
+	spins.push_back(spin);
+	radii.push_back(radius);
+	materials.push_back(material);
+	positions.push_back(position);
+	transforms.push_back(transform);
+
+	// the kinds after this one start behind it
+	for (int i = kind + 1; i <= BODY_KIND_COUNT; i++)
+	{
+		first[i] = index + 1;
+	}
+	return index;
+}
+
+void BodyStore::reserve(int count)
+{
+	kinds.reserve(count);
+	parents.reserve(count);
+	orbits.reserve(count);
+	spins.reserve(count);
+	radii.reserve(count);
+	materials.reserve(count);
+	positions.reserve(count);
+	transforms.reserve(count);
+	kepler.reserve(count);
+}
+
+int BodyStore::size(void) const
+{
+	return (int)kinds.size();
+}
+
+int BodyStore::begin(int kind) const
+{
+	return first[kind];
+}
+
+int BodyStore::end(int kind) const
+{
+	return first[kind + 1];
+}
+
+int BodyStore::count(int kind) const
+{
+	return first[kind + 1] - first[kind];
+}
+
+size_t BodyStore::getMemoryFootprint(void) const
+{
+	return kinds.capacity() * sizeof(int) + parents.capacity() * sizeof(int) +
+		orbits.capacity() * sizeof(BodyOrbit) + spins.capacity() * sizeof(BodySpin) +
+		radii.capacity() * sizeof(float) + materials.capacity() * sizeof(TextureHandle) +
+		positions.capacity() * sizeof(BodyPosition) + transforms.capacity() * sizeof(BodyTransform) +
+		kepler.getMemoryFootprint();
+}
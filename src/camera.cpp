@@ -1,11 +1,11 @@
-#ifdef _WIN32
-#include <Windows.h>
-#endif
-#include <glut.h>
 #include <cmath>
-#include <cstdio>
 #include "camera.h"
 
+// the axes of the camera before it is turned
+static constexpr Vec3 rightAxis = {1.0f, 0.0f, 0.0f};
+static constexpr Vec3 frontAxis = {0.0f, 1.0f, 0.0f};
+static constexpr Vec3 upAxis = {0.0f, 0.0f, 1.0f};
+
 // set vec to (x,y,z)
 void vectorSet(float* vec, float x, float y, float z)
 {
@@ -78,64 +78,109 @@ void mulVecBy(float* v1, float* matrix, float* v2)
 	v2[2] = v1[0] * matrix[6] + v1[1] * matrix[7] + v1[2] * matrix[8];
 }
 
+// add the offset to vec
+static void moveBy(float* vec, Vec3 offset)
+{
+	vec[0] += offset.x;
+	vec[1] += offset.y;
+	vec[2] += offset.z;
+}
+
 // rotate a vector v1 around the axis v2 by angle and put the result into v3
 void rotateAroundVec(float* v1, float* v2, float angle, float* v3)
 {
-	float matrix[16];
+	float matrix[9];
 	rotationMatrix(matrix, v2, angle);
 	mulVecBy(v1, matrix, v3);
 }
 
 Camera::Camera(void)
 {
-	// initial values are set by testing
-	cameraSpeed = 0.005f;
-	cameraTurnSpeed = 0.01f;
-	vectorSet(position, 0.764331460f, -1.66760659f, 0.642456770);
-	vectorSet(forwardVec,-0.398769796f, 0.763009906f, -0.508720219f);
-	vectorSet(rightVec, 0.886262059f, 0.463184059f, 0.000000000f);
-	vectorSet(upVec, -0.235630989f, 0.450859368f, 0.860931039f);
+	mouseUpDown = 0.0f;
+	mouseLeftRight = 0.0f;
+	reset();
 }
 
 void Camera::reset(void){
+	// initial values are set by testing
 	cameraSpeed = 0.005f;
 	cameraTurnSpeed = 0.01f;
 	vectorSet(position, 0.764331460f, -1.66760659f, 0.642456770);
-	vectorSet(forwardVec, -0.398769796f, 0.763009906f, -0.508720219f);
-	vectorSet(rightVec, 0.886262059f, 0.463184059f, 0.000000000f);
-	vectorSet(upVec, -0.235630989f, 0.450859368f, 0.860931039f);
+	setAxes(vec3(-0.398769796f, 0.763009906f, -0.508720219f), vec3(0.886262059f, 0.463184059f, 0.000000000f),
+		vec3(-0.235630989f, 0.450859368f, 0.860931039f));
 }
 
-void Camera::transformOrientation(void)
+void Camera::setAxes(Vec3 forward, Vec3 right, Vec3 up)
 {
-	float tempForward[3], tempUp[3], tempRight[3];
-	transformWithMouse(mouseLeftRight, mouseUpDown, tempForward, tempUp, tempRight);
+	orientation = fromAxes(right, forward, up);
+	viewChanged = true;
+}
 
-	// look at the direction of the orientation vectors
-	gluLookAt(0, 0, 0, tempForward[0], tempForward[1], tempForward[2], tempUp[0], tempUp[1], tempUp[2]);
+void Camera::getState(CameraState* state)
+{
+	Vec3 forward = rotate(orientation, frontAxis);
+	Vec3 right = rotate(orientation, rightAxis);
+	Vec3 up = rotate(orientation, upAxis);
+	vectorSet(state->forwardVec, forward.x, forward.y, forward.z);
+	vectorSet(state->rightVec, right.x, right.y, right.z);
+	vectorSet(state->upVec, up.x, up.y, up.z);
+	vectorCopy(state->position, position);
+	state->cameraSpeed = cameraSpeed;
+	state->cameraTurnSpeed = cameraTurnSpeed;
+	state->mouseUpDown = mouseUpDown;
+	state->mouseLeftRight = mouseLeftRight;
 }
 
-void Camera::transformTranslation(void)
+void Camera::setState(const CameraState* state)
 {
-	// translate to emulate camera position
-	glTranslatef(-position[0], -position[1], -position[2]);
+	setAxes(vec3(state->forwardVec[0], state->forwardVec[1], state->forwardVec[2]),
+		vec3(state->rightVec[0], state->rightVec[1], state->rightVec[2]),
+		vec3(state->upVec[0], state->upVec[1], state->upVec[2]));
+	for (int i = 0; i < 3; i++)
+	{
+		position[i] = state->position[i];
+	}
+	cameraSpeed = state->cameraSpeed;
+	cameraTurnSpeed = state->cameraTurnSpeed;
+	mouseUpDown = state->mouseUpDown;
+	mouseLeftRight = state->mouseLeftRight;
+}
+
+void Camera::getPosition(float* vec)
+{
+	vectorCopy(vec, position);
+}
+
+void Camera::getViewDirection(float* vec)
+{
+	updateView();
+	vectorSet(vec, viewForward.x, viewForward.y, viewForward.z);
+}
+
+void Camera::shift(float* vec)
+{
+	vectorAdd(position, vec);
 }
 
 // points the camera at the given point in 3d space
 void Camera::pointAt(float* targetVec)
 {
-	float tempVec[3];
-	float up[3] = { 0.0f, 0.0f, 1.0f };
-	forwardVec[0] = targetVec[0] - position[0];
-	forwardVec[1] = targetVec[1] - position[1];
-	forwardVec[2] = targetVec[2] - position[2];
-	normalizeVec(forwardVec);
-	rotateAroundVec(forwardVec, up, -1.57079632679f, tempVec);
-	tempVec[2] = 0;
-	normalizeVec(tempVec);
-	vectorCopy(rightVec, tempVec);
-	rotateAroundVec(forwardVec, rightVec, 1.57079632679f, tempVec);
-	vectorCopy(upVec, tempVec);
+	Vec3 forward = normalize(vec3(targetVec[0] - position[0], targetVec[1] - position[1], targetVec[2] - position[2]));
+
+	// keep the right level, unless the target is straight above or below
+	Vec3 right = vec3(forward.y, -forward.x, 0.0f);
+	if (length(right) < 1e-6f)
+	{
+		right = rotate(orientation, rightAxis);
+		right = right - forward * dot(right, forward);
+	}
+	right = normalize(right);
+	setAxes(forward, right, cross(right, forward));
+}
+
+float Camera::getSpeed(void)
+{
+	return cameraSpeed;
 }
 
 void Camera::speedUp(void)
@@ -152,60 +197,39 @@ void Camera::slowDown(void)
 
 void Camera::forward(void)
 {
-	float tempForward[3], tempUp[3], tempRight[3];
-	transformWithMouse(mouseLeftRight, mouseUpDown, tempForward, tempUp, tempRight);
-	float vec[3];
-	vectorCopy(vec, tempForward);
-	vectorMul(vec, cameraSpeed);
-	vectorAdd(position, vec);
+	updateView();
+	moveBy(position, viewForward * cameraSpeed);
 }
 
 void Camera::backward(void)
 {
-	float tempForward[3], tempUp[3], tempRight[3];
-	transformWithMouse(mouseLeftRight, mouseUpDown, tempForward, tempUp, tempRight);
-	float vec[3];
-	vectorCopy(vec, tempForward);
-	vectorMul(vec, -cameraSpeed);
-	vectorAdd(position, vec);
+	updateView();
+	moveBy(position, viewForward * -cameraSpeed);
 }
 
 void Camera::left(void)
 {
-	float tempForward[3], tempUp[3], tempRight[3];
-	transformWithMouse(mouseLeftRight, mouseUpDown, tempForward, tempUp, tempRight);
-	float vec[3];
-	vectorCopy(vec, tempRight);
-	vectorMul(vec, -cameraSpeed);
-	vectorAdd(position, vec);
+	updateView();
+	moveBy(position, viewRight * -cameraSpeed);
 }
 
 void Camera::right(void)
 {
-	float tempForward[3], tempUp[3], tempRight[3];
-	transformWithMouse(mouseLeftRight, mouseUpDown, tempForward, tempUp, tempRight);
-	float vec[3];
-	vectorCopy(vec, tempRight);
-	vectorMul(vec, cameraSpeed);
-	vectorAdd(position, vec);
+	updateView();
+	moveBy(position, viewRight * cameraSpeed);
 }
 
+// turning is done on the quaternion, which is normalized again so rounding never adds up
 void Camera::yawLeft(void)
 {
-	float tempVec[3];
-	rotateAroundVec(forwardVec, upVec, cameraTurnSpeed, tempVec);
-	vectorCopy(forwardVec, tempVec);
-	rotateAroundVec(rightVec, upVec, cameraTurnSpeed, tempVec);
-	vectorCopy(rightVec, tempVec);
+	orientation = normalize(orientation * axisAngle(upAxis, cameraTurnSpeed));
+	viewChanged = true;
 }
 
 void Camera::yawRight(void)
 {
-	float tempVec[3];
-	rotateAroundVec(forwardVec, upVec, -cameraTurnSpeed, tempVec);
-	vectorCopy(forwardVec, tempVec);
-	rotateAroundVec(rightVec, upVec, -cameraTurnSpeed, tempVec);
-	vectorCopy(rightVec, tempVec);
+	orientation = normalize(orientation * axisAngle(upAxis, -cameraTurnSpeed));
+	viewChanged = true;
 }
 
 void Camera::setMouse(float x, float y)
@@ -226,75 +250,34 @@ void Camera::setMouse(float x, float y)
 	}
 	mouseLeftRight = atan(x / z);
 	mouseUpDown = asin(y / 350);
+	viewChanged = true;
 }
 
-void Camera::transformWithMouse(float theta, float phi, float *forward, float *up, float *right)
+
+// turn around the up axis by theta and then around the turned right axis by phi
+Quat Camera::turnWithMouse(float theta, float phi)
 {
-	float tempForward[3], tempUp[3], tempRight[3], tempVec[3];
-	rotateAroundVec(forwardVec, upVec, theta, tempVec);
-	rotateAroundVec(rightVec, upVec, theta, tempRight);
-	rotateAroundVec(tempVec, tempRight, phi, tempForward);
-	rotateAroundVec(upVec, tempRight, phi, tempUp);
-	vectorCopy(forward, tempForward);
-	vectorCopy(right, tempRight);
-	vectorCopy(up, tempUp);
+	return orientation * axisAngle(upAxis, theta) * axisAngle(rightAxis, phi);
 }
 
-void Camera::saveImage(void)
+void Camera::updateView(void)
 {
-	GLint viewport[4];
-	glGetIntegerv(GL_VIEWPORT, viewport);
-	int width = viewport[2];
-	int height = viewport[3];
-
-	GLubyte* temp = new GLubyte[width * height * 4];
-	memset(temp, 0, width * height * 4);
-
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-	glReadPixels(0, 0, width, height, GL_BGR_EXT, GL_UNSIGNED_BYTE, temp);
-
-	GLubyte* pdata = new GLubyte[width * height * 3];
-	memset(pdata, 0, width * height * 3);
-
-	for (int i = 0; i < width * height * 3; i++){
-		pdata[i] = temp[i];
-	}
+	if (!viewChanged)
+		return;
+	Quat view = turnWithMouse(mouseLeftRight, mouseUpDown);
+	viewForward = rotate(view, frontAxis);
+	viewUp = rotate(view, upAxis);
+	viewRight = rotate(view, rightAxis);
+	viewChanged = false;
+}
 
-	BITMAPFILEHEADER Header;
-	memset(&Header, 0, sizeof(BITMAPFILEHEADER));
-	Header.bfType = 0x4D42;
-	Header.bfReserved1 = 0;
-	Header.bfReserved2 = 0;
-	Header.bfOffBits = (DWORD)(sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER));
-	Header.bfSize = (DWORD)(sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER) + 3 * width * height);
-
-	BITMAPINFOHEADER HeaderInfo;
-	memset(&HeaderInfo, 0, sizeof(BITMAPINFOHEADER));
-	HeaderInfo.biSize = (DWORD)sizeof(BITMAPINFOHEADER);
-	HeaderInfo.biWidth = width;
-	HeaderInfo.biHeight = height;
-	HeaderInfo.biPlanes = 1;
-	HeaderInfo.biBitCount = 24;
-	HeaderInfo.biCompression = 0;
-	HeaderInfo.biSizeImage = 3 * width * height;
-	HeaderInfo.biXPelsPerMeter = 0;
-	HeaderInfo.biYPelsPerMeter = 0;
-	HeaderInfo.biClrUsed = 0;
-	HeaderInfo.biClrImportant = 0;
-
-	SYSTEMTIME sys;
-	GetLocalTime(&sys);
-	char filename[64];
-	sprintf(filename, "Snapshot_%4d%02d%02d_%02d%02d%02d.bmp", sys.wYear, sys.wMonth, 
-		sys.wDay, sys.wHour, sys.wMinute, sys.wSecond);
-
-	FILE *pfile = fopen(filename, "wb+");
-	fwrite(&Header, 1, sizeof(BITMAPFILEHEADER), pfile);
-	fwrite(&HeaderInfo, 1, sizeof(BITMAPINFOHEADER), pfile);
-	for (int i = 0; i < width * height * 3; i++)
-	{
-		fwrite(&pdata[i], 1, sizeof(char), pfile);
-	}
-	fclose(pfile);
-	delete[] pdata;
-}
\ No newline at end of file
+void Camera::transformWithMouse(float theta, float phi, float *forward, float *up, float *right)
+{
+	Quat view = turnWithMouse(theta, phi);
+	Vec3 tempForward = rotate(view, frontAxis);
+	Vec3 tempUp = rotate(view, upAxis);
+	Vec3 tempRight = rotate(view, rightAxis);
+	vectorSet(forward, tempForward.x, tempForward.y, tempForward.z);
+	vectorSet(up, tempUp.x, tempUp.y, tempUp.z);
+	vectorSet(right, tempRight.x, tempRight.y, tempRight.z);
+}
@@ -0,0 +1,231 @@
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+#include <glut.h>
+#include <cstdio>
+#include "camera.h"
+#include "globals.h"
+#include "glextensions.h"
+
+void Camera::transformOrientation(void)
+{
+	updateView();
+
+	// look at the direction of the orientation vectors
+	gluLookAt(0, 0, 0, viewForward.x, viewForward.y, viewForward.z, viewUp.x, viewUp.y, viewUp.z);
+}
+
+void Camera::transformTranslation(void)
+{
+	// translate to emulate camera position
+	glTranslatef(-position[0], -position[1], -position[2]);
+}
+
+// fill in the bitmap headers for a 24-bit image of the given size
+void bitmapHeaders(BITMAPFILEHEADER* header, BITMAPINFOHEADER* headerInfo, int width, int height)
+{
+	// each row of a bitmap is padded to a multiple of 4 bytes
+	DWORD imageSize = (DWORD)(((width * 3 + 3) & ~3) * height);
+
+	memset(header, 0, sizeof(BITMAPFILEHEADER));
+	header->bfType = 0x4D42;
+	header->bfReserved1 = 0;
+	header->bfReserved2 = 0;
+	header->bfOffBits = (DWORD)(sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER));
+	header->bfSize = (DWORD)(sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER)) + imageSize;
+
+	memset(headerInfo, 0, sizeof(BITMAPINFOHEADER));
+	headerInfo->biSize = (DWORD)sizeof(BITMAPINFOHEADER);
+	headerInfo->biWidth = width;
+	headerInfo->biHeight = height;
+	headerInfo->biPlanes = 1;
+	headerInfo->biBitCount = 24;
+	headerInfo->biCompression = 0;
+	headerInfo->biSizeImage = imageSize;
+	headerInfo->biXPelsPerMeter = 0;
+	headerInfo->biYPelsPerMeter = 0;
+	headerInfo->biClrUsed = 0;
+	headerInfo->biClrImportant = 0;
+}
+
+// name a snapshot after the current local time
+void snapshotFilename(char* filename, const char* prefix)
+{
+	SYSTEMTIME sys;
+	GetLocalTime(&sys);
+	sprintf(filename, "%s_%4d%02d%02d_%02d%02d%02d.bmp", prefix, sys.wYear, sys.wMonth,
+		sys.wDay, sys.wHour, sys.wMinute, sys.wSecond);
+}
+
+void Camera::saveImage(void)
+{
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	int width = viewport[2];
+	int height = viewport[3];
+
+	GLubyte* temp = new GLubyte[width * height * 4];
+	memset(temp, 0, width * height * 4);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glReadPixels(0, 0, width, height, GL_BGR_EXT, GL_UNSIGNED_BYTE, temp);
+
+	GLubyte* pdata = new GLubyte[width * height * 3];
+	memset(pdata, 0, width * height * 3);
+
+	for (int i = 0; i < width * height * 3; i++){
+		pdata[i] = temp[i];
+	}
+
+	BITMAPFILEHEADER Header;
+	BITMAPINFOHEADER HeaderInfo;
+	bitmapHeaders(&Header, &HeaderInfo, width, height);
+
+	char filename[64];
+	snapshotFilename(filename, "Snapshot");
+
+	FILE *pfile = fopen(filename, "wb+");
+	fwrite(&Header, 1, sizeof(BITMAPFILEHEADER), pfile);
+	fwrite(&HeaderInfo, 1, sizeof(BITMAPINFOHEADER), pfile);
+	for (int i = 0; i < width * height * 3; i++)
+	{
+		fwrite(&pdata[i], 1, sizeof(char), pfile);
+	}
+	fclose(pfile);
+	delete[] temp;
+	delete[] pdata;
+}
+
+// tiles are at most this wide and high, which keeps a tile below 48MB
+static const int maxTileSize = 4096;
+
+// make an offscreen target of the given size to draw tiles into, return false if the driver can't
+static bool createTileTarget(int width, int height, GLuint* framebuffer, GLuint* renderbuffers)
+{
+	GLExtensions& gl = glExtensions;
+	if (!gl.framebuffers)
+		return false;
+	gl.genRenderbuffers(2, renderbuffers);
+	gl.bindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+	gl.renderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	gl.bindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+	gl.renderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	gl.bindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	gl.genFramebuffers(1, framebuffer);
+	gl.bindFramebuffer(GL_FRAMEBUFFER, *framebuffer);
+	gl.framebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+	gl.framebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+	if (gl.checkFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+		gl.deleteFramebuffers(1, framebuffer);
+		gl.deleteRenderbuffers(2, renderbuffers);
+		return false;
+	}
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	return true;
+}
+
+void Camera::saveTiledImage(int width, int height, void (*renderScene)(void))
+{
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	if (width <= 0 || height <= 0)
+		return;
+
+	// a bitmap can't address more than 2GB through fseek
+	int rowSize = (width * 3 + 3) & ~3;
+	if ((double)rowSize * height > 2147483647.0 - 1024.0)
+		return;
+
+	// tiles are drawn offscreen, as large as the driver allows
+	GLint maxRenderbuffer = 0, maxViewport[2] = {0, 0};
+	glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxRenderbuffer);
+	glGetIntegerv(GL_MAX_VIEWPORT_DIMS, maxViewport);
+	int maxTile = maxTileSize;
+	if (maxRenderbuffer < maxTile)
+		maxTile = maxRenderbuffer;
+	if (maxViewport[0] < maxTile)
+		maxTile = maxViewport[0];
+	if (maxViewport[1] < maxTile)
+		maxTile = maxViewport[1];
+	int tileWidth = width < maxTile ? width : maxTile;
+	int tileHeight = height < maxTile ? height : maxTile;
+	GLuint framebuffer = 0, renderbuffers[2] = {0, 0};
+	bool offscreen = tileWidth > 0 && tileHeight > 0 && createTileTarget(tileWidth, tileHeight, &framebuffer, renderbuffers);
+
+	// without offscreen targets the tiles go through the back buffer, which only works for a visible window
+	if (!offscreen)
+	{
+		tileWidth = viewport[2];
+		tileHeight = viewport[3];
+		if (tileWidth <= 0 || tileHeight <= 0)
+			return;
+	}
+
+	BITMAPFILEHEADER Header;
+	BITMAPINFOHEADER HeaderInfo;
+	bitmapHeaders(&Header, &HeaderInfo, width, height);
+
+	char filename[64];
+	snapshotFilename(filename, "Poster");
+
+	FILE *pfile = fopen(filename, "wb+");
+	if (pfile != NULL)
+	{
+		fwrite(&Header, 1, sizeof(BITMAPFILEHEADER), pfile);
+		fwrite(&HeaderInfo, 1, sizeof(BITMAPINFOHEADER), pfile);
+
+		// the frustum of the whole image, which is sliced up for the tiles
+		float top = nearPlane * tan(fieldOfView * 3.14159265f / 360.0f);
+		float right = top * (float)width / (float)height;
+
+		// only a single tile is held in memory at a time
+		GLubyte* tile = new GLubyte[tileWidth * tileHeight * 3];
+		GLubyte padding[3] = {0, 0, 0};
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+		// glReadPixels and bitmaps both go bottom up, so tile rows map to file rows directly
+		for (int y = 0; y < height; y += tileHeight)
+		{
+			int h = height - y < tileHeight ? height - y : tileHeight;
+			for (int x = 0; x < width; x += tileWidth)
+			{
+				int w = width - x < tileWidth ? width - x : tileWidth;
+
+				glViewport(0, 0, w, h);
+				glMatrixMode(GL_PROJECTION);
+				glLoadIdentity();
+				glFrustum(-right + 2.0f * right * x / width, -right + 2.0f * right * (x + w) / width,
+					-top + 2.0f * top * y / height, -top + 2.0f * top * (y + h) / height, nearPlane, farPlane);
+				glMatrixMode(GL_MODELVIEW);
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				glColor3f(1.0, 1.0, 1.0);
+				renderScene();
+
+				glReadPixels(0, 0, w, h, GL_BGR_EXT, GL_UNSIGNED_BYTE, tile);
+
+				// stream the rows of the tile to their places in the file
+				for (int r = 0; r < h; r++)
+				{
+					fseek(pfile, (long)(Header.bfOffBits + (y + r) * rowSize + x * 3), SEEK_SET);
+					fwrite(tile + r * w * 3, 1, w * 3, pfile);
+					if (x + w == width)
+						fwrite(padding, 1, rowSize - width * 3, pfile);
+				}
+			}
+		}
+		fclose(pfile);
+		delete[] tile;
+	}
+
+	if (offscreen)
+	{
+		glExtensions.bindFramebuffer(GL_FRAMEBUFFER, 0);
+		glExtensions.deleteFramebuffers(1, &framebuffer);
+		glExtensions.deleteRenderbuffers(2, renderbuffers);
+		glReadBuffer(GL_BACK);
+	}
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
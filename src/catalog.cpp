@@ -0,0 +1,378 @@
+#include "catalog.h"
+#include <cstring>
+#include <cstdlib>
+
+static const char catalogMagic[4] = {'S', 'W', 'M', 'C'};
+
+// index entries are written to the file in blocks of this many
+static const size_t indexBlock = 65536;
+
+// words of a body line up to the elements, counting the keyword, and the elements
+static const int bodyFields = 6;
+static const int elementFields = 5;
+
+// seek with 64-bit offsets, catalogs of millions of systems are larger than 2GB
+static bool seekFile(FILE* file, uint64_t offset)
+{
+#ifdef _WIN32
+	return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+	return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+Catalog::Catalog(void)
+{
+	header = NULL;
+	entries = NULL;
+	bodies = NULL;
+	assets = NULL;
+}
+
+bool Catalog::open(const char* path)
+{
+	header = NULL;
+	if (!file.open(path))
+		return false;
+	const unsigned char* data = file.getData();
+	uint64_t size = file.getSize();
+
+	// every part has to be inside the file and as large as its count says
+	const CatalogHeader* candidate = (const CatalogHeader*)data;
+	if (size < sizeof(CatalogHeader) || memcmp(candidate->magic, catalogMagic, sizeof(catalogMagic)) != 0 ||
+		candidate->version != catalogVersion || candidate->fileSize != size ||
+		candidate->indexOffset % 8 != 0 || candidate->bodiesOffset % 8 != 0 || candidate->assetsOffset % 8 != 0 ||
+		candidate->systemCount > size / sizeof(CatalogEntry) || candidate->bodyCount > size / sizeof(BodyRecord) ||
+		candidate->assetCount > size / sizeof(AssetRecord) ||
+		candidate->indexOffset > size || candidate->systemCount * sizeof(CatalogEntry) > size - candidate->indexOffset ||
+		candidate->bodiesOffset > size || candidate->bodyCount * sizeof(BodyRecord) > size - candidate->bodiesOffset ||
+		candidate->assetsOffset > size || candidate->assetCount * sizeof(AssetRecord) > size - candidate->assetsOffset)
+	{
+		file.close();
+		return false;
+	}
+	header = candidate;
+	entries = (const CatalogEntry*)(data + header->indexOffset);
+	bodies = (const BodyRecord*)(data + header->bodiesOffset);
+	assets = (const AssetRecord*)(data + header->assetsOffset);
+
+	for (uint32_t i = 0; i < header->assetCount; i++)
+	{
+		if (memchr(assets[i].name, 0, sizeof(assets[i].name)) == NULL)
+		{
+			header = NULL;
+			file.close();
+			return false;
+		}
+	}
+	return true;
+}
+
+uint64_t Catalog::getSystemCount(void)
+{
+	return header != NULL ? header->systemCount : 0;
+}
+
+uint32_t Catalog::getAssetCount(void)
+{
+	return header != NULL ? header->assetCount : 0;
+}
+
+const char* Catalog::getAssetName(uint32_t index)
+{
+	if (header == NULL || index >= header->assetCount)
+		return NULL;
+	return assets[index].name;
+}
+
+bool Catalog::getSystem(uint64_t index, const std::vector<TextureHandle>& textures, std::vector<BodyDesc>& bodies)
+{
+	bodies.clear();
+	if (header == NULL || index >= header->systemCount)
+		return false;
+	const CatalogEntry& entry = entries[index];
+	if (entry.firstBody > header->bodyCount || entry.bodyCount > header->bodyCount - entry.firstBody)
+		return false;
+
+	const BodyRecord* records = this->bodies + entry.firstBody;
+	bodies.resize(entry.bodyCount);
+	for (uint32_t i = 0; i < entry.bodyCount; i++)
+	{
+		const BodyRecord& record = records[i];
+		BodyDesc& desc = bodies[i];
+		if (record.kind < BODY_PLANET || record.kind >= BODY_KIND_COUNT || record.asset < -1 || record.asset >= (int32_t)header->assetCount ||
+			(record.kind == BODY_MOON && (record.parent < 0 || record.parent >= (int32_t)i || records[record.parent].kind != BODY_PLANET)) ||
+			!(record.elements.eccentricity >= 0.0f && record.elements.eccentricity < 1.0f))
+		{
+			bodies.clear();
+			return false;
+		}
+		desc.kind = record.kind;
+		desc.parent = record.kind == BODY_MOON ? record.parent : -1;
+		desc.distance = record.distance;
+		desc.orbitTime = record.orbitTime;
+		desc.rotationTime = record.rotationTime;
+		desc.radius = record.radius;
+		desc.textureHandle = record.asset >= 0 && record.asset < (int32_t)textures.size() ? textures[record.asset] : 0;
+		desc.elements = record.elements;
+	}
+	return true;
+}
+
+// the number of words of a line separated by blanks
+static int countWords(const char* line)
+{
+	int words = 0;
+	bool inWord = false;
+	for (const char* c = line; *c != 0; c++)
+	{
+		bool blank = *c == ' ' || *c == '\t' || *c == '\r' || *c == '\n';
+		if (!blank && !inWord)
+			words++;
+		inWord = !blank;
+	}
+	return words;
+}
+
+// The source is a list of lines, # starts a comment. Each system is started by a line
+//   system <name>
+// and followed by its bodies, moons orbit the planet before them, distances in km and times in days
+//   planet <distance> <orbit time> <rotation time> <radius> <image> [elements]
+//   moon <distance from planet> <orbit time> <rotation time> <radius> <image> [elements]
+//   wormhole <distance> <orbit time> <rotation time> <radius> <image> [elements]
+// where the optional elements are, in this order and in degrees where they are angles
+//   <eccentricity> <inclination> <ascending node> <periapsis> <mean anomaly>
+bool Catalog::compile(const char* sourcePath, const char* catalogPath, std::string* error)
+{
+	FILE* source = fopen(sourcePath, "r");
+	if (source == NULL)
+	{
+		*error = std::string("can't open ") + sourcePath;
+		return false;
+	}
+
+	std::vector<std::vector<BodyRecord> > systems;
+	std::vector<std::string> assetNames;
+	char line[512];
+	int lineNumber = 0;
+	bool ok = true;
+	while (ok && fgets(line, sizeof(line), source) != NULL)
+	{
+		lineNumber++;
+		char* comment = strchr(line, '#');
+		if (comment != NULL)
+			*comment = 0;
+
+		char keyword[32], image[256];
+		BodyRecord record;
+		memset(&record, 0, sizeof(record));
+		if (sscanf(line, "%31s", keyword) != 1)
+			continue;
+
+		if (strcmp(keyword, "system") == 0)
+		{
+			systems.push_back(std::vector<BodyRecord>());
+			continue;
+		}
+		if (strcmp(keyword, "planet") == 0)
+			record.kind = BODY_PLANET;
+		else if (strcmp(keyword, "moon") == 0)
+			record.kind = BODY_MOON;
+		else if (strcmp(keyword, "wormhole") == 0)
+			record.kind = BODY_WORMHOLE;
+		else
+		{
+			*error = "unknown keyword";
+			ok = false;
+			break;
+		}
+
+		if (systems.empty())
+		{
+			*error = "body before the first system";
+			ok = false;
+			break;
+		}
+		// a circular orbit has no elements, any others have all five of them
+		OrbitElements& elements = record.elements;
+		int words = countWords(line);
+		int fields = sscanf(line, "%31s %f %f %f %f %255s %f %f %f %f %f", keyword, &record.distance, &record.orbitTime,
+			&record.rotationTime, &record.radius, image, &elements.eccentricity, &elements.inclination,
+			&elements.ascendingNode, &elements.periapsis, &elements.meanAnomaly);
+		if (fields != words || (fields != bodyFields && fields != bodyFields + elementFields) ||
+			strlen(image) >= sizeof(((AssetRecord*)0)->name))
+		{
+			*error = "expected a distance, an orbit time, a rotation time, a radius and an image, then none or all five elements";
+			ok = false;
+			break;
+		}
+		if (!(elements.eccentricity >= 0.0f && elements.eccentricity < 1.0f))
+		{
+			*error = "the eccentricity must be at least 0 and less than 1";
+			ok = false;
+			break;
+		}
+
+		// moons belong to the closest planet above them
+		std::vector<BodyRecord>& system = systems.back();
+		record.parent = -1;
+		if (record.kind == BODY_MOON)
+		{
+			for (int i = (int)system.size() - 1; i >= 0 && record.parent < 0; i--)
+			{
+				if (system[i].kind == BODY_PLANET)
+					record.parent = i;
+			}
+			if (record.parent < 0)
+			{
+				*error = "moon without a planet";
+				ok = false;
+				break;
+			}
+		}
+
+		record.asset = -1;
+		for (int i = 0; i < assetNames.size() && record.asset < 0; i++)
+		{
+			if (assetNames[i] == image)
+				record.asset = i;
+		}
+		if (record.asset < 0)
+		{
+			record.asset = (int32_t)assetNames.size();
+			assetNames.push_back(image);
+		}
+		system.push_back(record);
+	}
+	fclose(source);
+
+	if (!ok)
+	{
+		char location[64];
+		sprintf(location, "%s:%d: ", sourcePath, lineNumber);
+		*error = location + *error;
+		return false;
+	}
+
+	CatalogWriter writer;
+	ok = writer.open(catalogPath, systems.size(), assetNames);
+	for (int i = 0; ok && i < systems.size(); i++)
+	{
+		ok = writer.addSystem(systems[i].empty() ? NULL : &systems[i][0], (uint32_t)systems[i].size());
+	}
+	ok = writer.close() && ok;
+	if (!ok)
+		*error = std::string("can't write ") + catalogPath;
+	return ok;
+}
+
+CatalogWriter::CatalogWriter(void)
+{
+	file = NULL;
+	systemCount = 0;
+	systemsWritten = 0;
+	bodiesWritten = 0;
+	pendingFirst = 0;
+}
+
+CatalogWriter::~CatalogWriter(void)
+{
+	if (file != NULL)
+		fclose(file);
+}
+
+// the index comes right after the header and the bodies right after the index
+static uint64_t indexOffset(void)
+{
+	return sizeof(CatalogHeader);
+}
+
+static uint64_t bodiesOffset(uint64_t systemCount)
+{
+	return indexOffset() + systemCount * sizeof(CatalogEntry);
+}
+
+bool CatalogWriter::open(const char* path, uint64_t systemCount, const std::vector<std::string>& assetNames)
+{
+	file = fopen(path, "wb");
+	if (file == NULL)
+		return false;
+	this->systemCount = systemCount;
+	systemsWritten = 0;
+	bodiesWritten = 0;
+	pendingFirst = 0;
+	pending.clear();
+
+	assets.resize(assetNames.size());
+	for (int i = 0; i < assetNames.size(); i++)
+	{
+		memset(&assets[i], 0, sizeof(AssetRecord));
+		strncpy(assets[i].name, assetNames[i].c_str(), sizeof(assets[i].name) - 1);
+	}
+
+	// bodies are streamed behind room left for the header and the index
+	return seekFile(file, bodiesOffset(systemCount));
+}
+
+bool CatalogWriter::flushIndex(void)
+{
+	if (pending.empty())
+		return true;
+	bool ok = seekFile(file, indexOffset() + pendingFirst * sizeof(CatalogEntry)) &&
+		fwrite(&pending[0], sizeof(CatalogEntry), pending.size(), file) == pending.size() &&
+		seekFile(file, bodiesOffset(systemCount) + bodiesWritten * sizeof(BodyRecord));
+	pendingFirst += pending.size();
+	pending.clear();
+	return ok;
+}
+
+bool CatalogWriter::addSystem(const BodyRecord* records, uint32_t count)
+{
+	if (file == NULL || systemsWritten >= systemCount)
+		return false;
+
+	CatalogEntry entry;
+	entry.firstBody = bodiesWritten;
+	entry.bodyCount = count;
+	entry.reserved = 0;
+	pending.push_back(entry);
+	systemsWritten++;
+
+	if (count > 0 && fwrite(records, sizeof(BodyRecord), count, file) != count)
+		return false;
+	bodiesWritten += count;
+
+	if (pending.size() >= indexBlock)
+		return flushIndex();
+	return true;
+}
+
+bool CatalogWriter::close(void)
+{
+	if (file == NULL)
+		return false;
+	bool ok = flushIndex() && systemsWritten == systemCount;
+
+	// texture names go at the end, 8-byte aligned
+	uint64_t assetsOffset = (bodiesOffset(systemCount) + bodiesWritten * sizeof(BodyRecord) + 7) & ~(uint64_t)7;
+	ok = ok && seekFile(file, assetsOffset);
+	if (ok && !assets.empty())
+		ok = fwrite(&assets[0], sizeof(AssetRecord), assets.size(), file) == assets.size();
+
+	CatalogHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, catalogMagic, sizeof(catalogMagic));
+	header.version = catalogVersion;
+	header.systemCount = systemCount;
+	header.bodyCount = bodiesWritten;
+	header.assetCount = (uint32_t)assets.size();
+	header.indexOffset = indexOffset();
+	header.bodiesOffset = bodiesOffset(systemCount);
+	header.assetsOffset = assetsOffset;
+	header.fileSize = assetsOffset + assets.size() * sizeof(AssetRecord);
+	ok = ok && seekFile(file, 0) && fwrite(&header, sizeof(header), 1, file) == 1;
+
+	ok = fclose(file) == 0 && ok;
+	file = NULL;
+	return ok;
+}
@@ -0,0 +1,158 @@
+#include "destinationbuilder.h"
+#include "random.h"
+
+DestinationBuilder::DestinationBuilder(const SystemGenerator* generator, Catalog* catalog, const std::vector<TextureHandle>& catalogTextures)
+{
+	this->generator = generator;
+	this->catalog = catalog;
+	this->catalogTextures = catalogTextures;
+	stopping = false;
+	requested = false;
+	requestedId = 0;
+	ready = NULL;
+	readyId = 0;
+	worker = std::thread(&DestinationBuilder::run, this);
+}
+
+DestinationBuilder::~DestinationBuilder(void)
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_all();
+	worker.join();
+
+	delete ready;
+	for (int i = 0; i < retired.size(); i++)
+	{
+		delete retired[i];
+	}
+}
+
+uint64_t DestinationBuilder::destination(uint64_t from, uint64_t seed)
+{
+	// one in six wormholes leads to a known system of the catalog
+	Random random(Random::combine(from, seed));
+	uint64_t known = catalog->getSystemCount();
+	if (known > 0 && random.range(6) == 0)
+		return random.next() % known;
+
+	return generatedId(random.next());
+}
+
+uint64_t DestinationBuilder::generatedId(uint64_t seed)
+{
+	Random random(seed);
+	uint64_t known = catalog->getSystemCount();
+	uint64_t id = random.next();
+	while (id < known)
+	{
+		id = random.next();
+	}
+	return id;
+}
+
+SolarSystem* DestinationBuilder::build(uint64_t id)
+{
+	std::vector<BodyDesc> bodies;
+	if (id < catalog->getSystemCount())
+		catalog->getSystem(id, catalogTextures, bodies);
+	else
+		generator->generate(id, bodies);
+	return new SolarSystem(bodies);
+}
+
+void DestinationBuilder::prepare(uint64_t id)
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (requested || (ready != NULL && readyId == id))
+			return;
+
+		// a system built for another wormhole isn't needed anymore
+		if (ready != NULL)
+		{
+			retired.push_back(ready);
+			ready = NULL;
+		}
+		requested = true;
+		requestedId = id;
+	}
+	wake.notify_all();
+}
+
+SolarSystem* DestinationBuilder::peek(void)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return ready;
+}
+
+SolarSystem* DestinationBuilder::take(uint64_t id)
+{
+	SolarSystem* system = NULL;
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		while (requested)
+		{
+			wake.wait(guard);
+		}
+		if (ready != NULL && readyId == id)
+		{
+			system = ready;
+			ready = NULL;
+		}
+	}
+
+	// the destination wasn't prepared in time
+	if (system == NULL)
+		system = build(id);
+	return system;
+}
+
+void DestinationBuilder::retire(SolarSystem* system)
+{
+	if (system == NULL)
+		return;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		retired.push_back(system);
+	}
+	wake.notify_all();
+}
+
+void DestinationBuilder::run(void)
+{
+	std::unique_lock<std::mutex> guard(lock);
+	while (true)
+	{
+		while (!requested && retired.empty() && !stopping)
+		{
+			wake.wait(guard);
+		}
+		if (stopping)
+			return;
+
+		// work on a copy of the queue, so the lock isn't held while destroying
+		std::vector<SolarSystem*> garbage;
+		garbage.swap(retired);
+		bool building = requested;
+		uint64_t buildId = requestedId;
+		guard.unlock();
+
+		for (int i = 0; i < garbage.size(); i++)
+		{
+			delete garbage[i];
+		}
+		SolarSystem* system = building ? build(buildId) : NULL;
+
+		guard.lock();
+		if (building)
+		{
+			ready = system;
+			readyId = buildId;
+			requested = false;
+			wake.notify_all();
+		}
+	}
+}
@@ -0,0 +1,154 @@
+#include "flightplan.h"
+#include <cmath>
+#include "globals.h"
+
+// plans are handed to the threads this many at a time unless told otherwise
+static const int defaultGrain = 16;
+
+FlightEvaluator::FlightEvaluator(SolarSystem* system, JobSystem* jobs, double step)
+{
+	this->system = system;
+	this->jobs = jobs;
+	this->step = step;
+	grain = defaultGrain;
+	target = -1;
+	arrival = 0.0f;
+	plans = NULL;
+	reports = NULL;
+	now = 0.0;
+	startTime = 0.0;
+	endTime = 0.0;
+	stepCount = 0;
+	stepsDone = 0;
+}
+
+void FlightEvaluator::setStep(double step)
+{
+	this->step = step;
+}
+
+void FlightEvaluator::setTarget(int planet, float arrival)
+{
+	target = planet;
+	this->arrival = arrival;
+}
+
+void FlightEvaluator::setGrain(int grain)
+{
+	this->grain = grain > 0 ? grain : 1;
+}
+
+void FlightEvaluator::evaluatePlans(void* data, int begin, int end)
+{
+	FlightEvaluator* evaluator = (FlightEvaluator*)data;
+	double now = evaluator->now;
+	for (int i = begin; i < end; i++)
+	{
+		const std::vector<FlightPoint>& points = (*evaluator->plans)[i].points;
+		FlightReport& report = (*evaluator->reports)[i];
+		if (points.empty() || report.contactTime >= 0.0 || report.arrivalTime >= 0.0 ||
+			now < points.front().time || now > points.back().time)
+			continue;
+
+		// find the points the ship is between, they only ever move forward
+		int& cursor = evaluator->cursors[i];
+		while (cursor + 2 < (int)points.size() && points[cursor + 1].time <= now)
+		{
+			cursor++;
+		}
+		const FlightPoint& from = points[cursor];
+		const FlightPoint& to = points[cursor + 1 < (int)points.size() ? cursor + 1 : cursor];
+		double span = to.time - from.time;
+		float along = span > 0.0 ? (float)((now - from.time) / span) : 0.0f;
+		float position[3];
+		for (int j = 0; j < 3; j++)
+		{
+			position[j] = from.position[j] + (to.position[j] - from.position[j]) * along;
+		}
+
+		float clearance = evaluator->system->testDistancewithPlanet(position);
+		if (clearance < report.minClearance)
+		{
+			report.minClearance = clearance;
+			report.minClearanceTime = now;
+		}
+		if (clearance < contactDistance)
+			report.contactTime = now;
+		else if (evaluator->target >= 0 && evaluator->system->getDistanceToPlanet(evaluator->target, position) < evaluator->arrival)
+			report.arrivalTime = now;
+
+		// a wormhole counts again only once the ship has come out of it
+		bool inside = evaluator->system->testDistancewithWormhole(position) < contactDistance;
+		if (inside && !evaluator->inWormhole[i])
+		{
+			if (report.wormholeEntries == 0)
+				report.firstWormholeTime = now;
+			report.wormholeEntries++;
+		}
+		evaluator->inWormhole[i] = inside;
+	}
+}
+
+void FlightEvaluator::evaluate(const std::vector<FlightPlan>& plans, std::vector<FlightReport>& reports)
+{
+	begin(plans, reports);
+	advance(stepCount);
+}
+
+void FlightEvaluator::begin(const std::vector<FlightPlan>& plans, std::vector<FlightReport>& reports)
+{
+	reports.resize(plans.size());
+	cursors.assign(plans.size(), 0);
+	inWormhole.assign(plans.size(), 0);
+	this->plans = &plans;
+	this->reports = &reports;
+	stepCount = 0;
+	stepsDone = 0;
+
+	// the time covered by all plans
+	bool any = false;
+	for (int i = 0; i < plans.size(); i++)
+	{
+		FlightReport& report = reports[i];
+		report.contactTime = -1.0;
+		report.minClearance = 10000.0f;
+		report.minClearanceTime = -1.0;
+		report.arrivalTime = -1.0;
+		report.wormholeEntries = 0;
+		report.firstWormholeTime = -1.0;
+
+		const std::vector<FlightPoint>& points = plans[i].points;
+		if (points.empty())
+			continue;
+		if (!any || points.front().time < startTime)
+			startTime = points.front().time;
+		if (!any || points.back().time > endTime)
+			endTime = points.back().time;
+		any = true;
+	}
+	if (!any || step <= 0.0)
+		return;
+
+	// the last step lands on the end, however the steps divide the time
+	stepCount = (int)ceil((endTime - startTime) / step) + 1;
+}
+
+bool FlightEvaluator::advance(int steps)
+{
+	int last = stepsDone + steps < stepCount ? stepsDone + steps : stepCount;
+	for (; stepsDone < last; stepsDone++)
+	{
+		now = stepsDone < stepCount - 1 ? startTime + stepsDone * step : endTime;
+		system->calculatePositions(SimulationTime(now));
+		if (jobs != NULL)
+			jobs->parallelFor((int)plans->size(), grain, evaluatePlans, this);
+		else
+			evaluatePlans(this, 0, (int)plans->size());
+	}
+	return stepsDone >= stepCount;
+}
+
+int FlightEvaluator::getStepCount(void)
+{
+	return stepCount;
+}
@@ -0,0 +1,3 @@
+#include "glcount.h"
+
+GLCallCounts glCalls;
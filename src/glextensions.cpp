@@ -0,0 +1,89 @@
+#include "glextensions.h"
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+#include <GL/glx.h>
+#endif
+
+GLExtensions glExtensions;
+
+static void* getProcedure(const char* name)
+{
+#ifdef _WIN32
+	// some drivers hand out small numbers instead of NULL for what they don't have
+	void* procedure = (void*)wglGetProcAddress(name);
+	if (procedure == (void*)1 || procedure == (void*)2 || procedure == (void*)3 || procedure == (void*)-1)
+		return NULL;
+	return procedure;
+#else
+	return (void*)glXGetProcAddressARB((const GLubyte*)name);
+#endif
+}
+
+// look up one entry point into a function pointer of any type, return whether it was found
+template <class Function>
+static bool load(Function& function, const char* name)
+{
+	function = (Function)getProcedure(name);
+	return function != NULL;
+}
+
+static bool hasVersion(int major, int minor)
+{
+	const char* version = (const char*)glGetString(GL_VERSION);
+	int haveMajor = 0, haveMinor = 0;
+	if (version == NULL || sscanf(version, "%d.%d", &haveMajor, &haveMinor) != 2)
+		return false;
+	return haveMajor > major || (haveMajor == major && haveMinor >= minor);
+}
+
+static bool hasExtension(const char* name)
+{
+	const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+	if (extensions == NULL)
+		return false;
+
+	// the name must match a whole word of the list
+	size_t length = strlen(name);
+	for (const char* found = strstr(extensions, name); found != NULL; found = strstr(found + length, name))
+	{
+		if ((found == extensions || found[-1] == ' ') && (found[length] == ' ' || found[length] == 0))
+			return true;
+	}
+	return false;
+}
+
+void loadGLExtensions(void)
+{
+	memset(&glExtensions, 0, sizeof(glExtensions));
+	GLExtensions& gl = glExtensions;
+
+	if (hasVersion(1, 5))
+	{
+		gl.buffers = load(gl.genBuffers, "glGenBuffers") && load(gl.deleteBuffers, "glDeleteBuffers") &&
+			load(gl.bindBuffer, "glBindBuffer") && load(gl.bufferData, "glBufferData") &&
+			load(gl.mapBuffer, "glMapBuffer") && load(gl.unmapBuffer, "glUnmapBuffer");
+	}
+	if (hasVersion(1, 4))
+		gl.multiDraw = load(gl.multiDrawArrays, "glMultiDrawArrays");
+	if (gl.buffers && (hasVersion(4, 4) || (hasExtension("GL_ARB_buffer_storage") && (hasVersion(3, 2) || hasExtension("GL_ARB_sync")))))
+	{
+		gl.persistentBuffers = load(gl.bufferStorage, "glBufferStorage") && load(gl.mapBufferRange, "glMapBufferRange") &&
+			load(gl.fenceSync, "glFenceSync") && load(gl.clientWaitSync, "glClientWaitSync") && load(gl.deleteSync, "glDeleteSync");
+	}
+	if (hasVersion(3, 3) || hasExtension("GL_ARB_timer_query"))
+	{
+		gl.timerQueries = load(gl.genQueries, "glGenQueries") && load(gl.deleteQueries, "glDeleteQueries") &&
+			load(gl.queryCounter, "glQueryCounter") && load(gl.getQueryObjectiv, "glGetQueryObjectiv") &&
+			load(gl.getQueryObjectui64v, "glGetQueryObjectui64v") && load(gl.getInteger64v, "glGetInteger64v");
+	}
+	if (hasVersion(3, 0) || hasExtension("GL_ARB_framebuffer_object"))
+	{
+		gl.framebuffers = load(gl.genFramebuffers, "glGenFramebuffers") && load(gl.deleteFramebuffers, "glDeleteFramebuffers") &&
+			load(gl.bindFramebuffer, "glBindFramebuffer") && load(gl.checkFramebufferStatus, "glCheckFramebufferStatus") &&
+			load(gl.genRenderbuffers, "glGenRenderbuffers") && load(gl.deleteRenderbuffers, "glDeleteRenderbuffers") &&
+			load(gl.bindRenderbuffer, "glBindRenderbuffer") && load(gl.renderbufferStorage, "glRenderbufferStorage") &&
+			load(gl.framebufferRenderbuffer, "glFramebufferRenderbuffer");
+	}
+}
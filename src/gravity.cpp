@@ -0,0 +1,547 @@
+#include "gravity.h"
+#include <cmath>
+#include "random.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define SWM_GRAVITY_SSE
+#endif
+
+// leaves hold up to this many bodies, deeper trees are cut off for bodies on top of each other
+static const int leafSize = 8;
+static const int maxDepth = 32;
+
+// bodies walking the tree together at most
+static const int groupSize = 64;
+
+// bodies a task works out the forces for at least, and groups for the tree
+static const int forceGrain = 256;
+static const int groupGrain = 8;
+
+GravitySimulation::GravitySimulation(JobSystem* jobs)
+{
+	this->jobs = jobs;
+	theta = 0.7f;
+	softening = 1e-8;
+	accelerated = false;
+}
+
+void GravitySimulation::clear(void)
+{
+	x.clear(); y.clear(); z.clear();
+	vx.clear(); vy.clear(); vz.clear();
+	ax.clear(); ay.clear(); az.clear();
+	mass.clear();
+	accelerated = false;
+}
+
+int GravitySimulation::add(const GravityBody& body)
+{
+	x.push_back(body.position[0]);
+	y.push_back(body.position[1]);
+	z.push_back(body.position[2]);
+	vx.push_back(body.velocity[0]);
+	vy.push_back(body.velocity[1]);
+	vz.push_back(body.velocity[2]);
+	ax.push_back(0.0);
+	ay.push_back(0.0);
+	az.push_back(0.0);
+	mass.push_back(body.mass);
+	accelerated = false;
+	return (int)x.size() - 1;
+}
+
+int GravitySimulation::getBodyCount(void)
+{
+	return (int)x.size();
+}
+
+void GravitySimulation::getBody(int index, GravityBody* body)
+{
+	body->position[0] = x[index];
+	body->position[1] = y[index];
+	body->position[2] = z[index];
+	body->velocity[0] = vx[index];
+	body->velocity[1] = vy[index];
+	body->velocity[2] = vz[index];
+	body->mass = mass[index];
+}
+
+void GravitySimulation::setPosition(int index, const double* position)
+{
+	x[index] = position[0];
+	y[index] = position[1];
+	z[index] = position[2];
+}
+
+void GravitySimulation::setVelocity(int index, const double* velocity)
+{
+	vx[index] = velocity[0];
+	vy[index] = velocity[1];
+	vz[index] = velocity[2];
+}
+
+void GravitySimulation::setTheta(float theta)
+{
+	this->theta = theta < 0.0f ? 0.0f : theta;
+}
+
+float GravitySimulation::getTheta(void)
+{
+	return theta;
+}
+
+void GravitySimulation::setSoftening(double softening)
+{
+	this->softening = softening;
+}
+
+void GravitySimulation::addRing(int count, double inner, double outer, double centralMass, double totalMass, uint64_t seed)
+{
+	Random random(seed);
+	GravityBody body;
+	body.mass = count > 0 ? totalMass / count : 0.0;
+	for (int i = 0; i < count; i++)
+	{
+		// spread evenly over the area of the ring, a little above and below the plane
+		double r = sqrt(inner * inner + (outer * outer - inner * inner) * random.uniform(0.0f, 1.0f));
+		double angle = random.uniform(0.0f, 6.283185307f);
+		double speed = sqrt(centralMass / r);
+		body.position[0] = sin(angle) * r;
+		body.position[1] = cos(angle) * r;
+		body.position[2] = (outer - inner) * random.uniform(-0.02f, 0.02f);
+
+		// the same direction as the planets go round
+		body.velocity[0] = cos(angle) * speed;
+		body.velocity[1] = -sin(angle) * speed;
+		body.velocity[2] = 0.0;
+		add(body);
+	}
+}
+
+void GravitySimulation::removeDrift(void)
+{
+	double total = 0.0, momentum[3] = {0.0, 0.0, 0.0};
+	for (int i = 0; i < x.size(); i++)
+	{
+		total += mass[i];
+		momentum[0] += mass[i] * vx[i];
+		momentum[1] += mass[i] * vy[i];
+		momentum[2] += mass[i] * vz[i];
+	}
+	if (total <= 0.0)
+		return;
+	for (int i = 0; i < x.size(); i++)
+	{
+		vx[i] -= momentum[0] / total;
+		vy[i] -= momentum[1] / total;
+		vz[i] -= momentum[2] / total;
+	}
+}
+
+void GravitySimulation::buildTree(void)
+{
+	int count = (int)x.size();
+	nodes.clear();
+	groups.clear();
+	order.resize(count);
+	scratch.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		order[i] = i;
+	}
+
+	// the root is the smallest cube around all bodies
+	double low[3] = {1e300, 1e300, 1e300}, high[3] = {-1e300, -1e300, -1e300};
+	for (int i = 0; i < count; i++)
+	{
+		low[0] = fmin(low[0], x[i]); high[0] = fmax(high[0], x[i]);
+		low[1] = fmin(low[1], y[i]); high[1] = fmax(high[1], y[i]);
+		low[2] = fmin(low[2], z[i]); high[2] = fmax(high[2], z[i]);
+	}
+	Node root;
+	root.halfSize = 0.0;
+	for (int i = 0; i < 3; i++)
+	{
+		root.center[i] = count > 0 ? (low[i] + high[i]) * 0.5 : 0.0;
+		if (count > 0)
+			root.halfSize = fmax(root.halfSize, (high[i] - low[i]) * 0.5);
+	}
+	root.halfSize = root.halfSize * 1.0001 + 1e-12;
+	nodes.push_back(root);
+	buildNode(0, 0, count, 0, false);
+}
+
+void GravitySimulation::finishLeaf(Node& node)
+{
+	node.children = -1;
+	node.mass = 0.0;
+	double weighted[3] = {0.0, 0.0, 0.0};
+	for (int k = node.first; k < node.first + node.count; k++)
+	{
+		int i = order[k];
+		node.mass += mass[i];
+		weighted[0] += mass[i] * x[i];
+		weighted[1] += mass[i] * y[i];
+		weighted[2] += mass[i] * z[i];
+	}
+	for (int j = 0; j < 3; j++)
+	{
+		node.massCenter[j] = node.mass > 0.0 ? weighted[j] / node.mass : node.center[j];
+	}
+}
+
+void GravitySimulation::buildNode(int index, int first, int count, int depth, bool grouped)
+{
+	// nodes may move while children are added, so they are only reached by index
+	nodes[index].first = first;
+	nodes[index].count = count;
+
+	// a leaf is always grouped, even if the bodies piled up on it are more than a group holds
+	bool leaf = count <= leafSize || depth >= maxDepth;
+	if (!grouped && count > 0 && (count <= groupSize || leaf))
+	{
+		groups.push_back(index);
+		grouped = true;
+	}
+	if (leaf)
+	{
+		finishLeaf(nodes[index]);
+		return;
+	}
+
+	// sort the bodies into the eight octants, a counting sort keeps it linear
+	double center[3] = {nodes[index].center[0], nodes[index].center[1], nodes[index].center[2]};
+	int counts[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+	for (int k = first; k < first + count; k++)
+	{
+		int i = order[k];
+		int octant = (x[i] >= center[0] ? 1 : 0) | (y[i] >= center[1] ? 2 : 0) | (z[i] >= center[2] ? 4 : 0);
+		counts[octant]++;
+	}
+	int starts[8], next[8];
+	starts[0] = first;
+	for (int c = 1; c < 8; c++)
+	{
+		starts[c] = starts[c - 1] + counts[c - 1];
+	}
+	for (int c = 0; c < 8; c++)
+	{
+		next[c] = starts[c];
+	}
+	for (int k = first; k < first + count; k++)
+	{
+		int i = order[k];
+		int octant = (x[i] >= center[0] ? 1 : 0) | (y[i] >= center[1] ? 2 : 0) | (z[i] >= center[2] ? 4 : 0);
+		scratch[next[octant]++] = i;
+	}
+	for (int k = first; k < first + count; k++)
+	{
+		order[k] = scratch[k];
+	}
+
+	// the children are kept together, so a node only needs the index of the first
+	int children = (int)nodes.size();
+	double half = nodes[index].halfSize * 0.5;
+	nodes[index].children = children;
+	for (int c = 0; c < 8; c++)
+	{
+		Node child;
+		child.center[0] = center[0] + ((c & 1) ? half : -half);
+		child.center[1] = center[1] + ((c & 2) ? half : -half);
+		child.center[2] = center[2] + ((c & 4) ? half : -half);
+		child.halfSize = half;
+		nodes.push_back(child);
+	}
+
+	double total = 0.0, weighted[3] = {0.0, 0.0, 0.0};
+	for (int c = 0; c < 8; c++)
+	{
+		buildNode(children + c, starts[c], counts[c], depth + 1, grouped);
+		const Node& child = nodes[children + c];
+		total += child.mass;
+		weighted[0] += child.mass * child.massCenter[0];
+		weighted[1] += child.mass * child.massCenter[1];
+		weighted[2] += child.mass * child.massCenter[2];
+	}
+	Node& node = nodes[index];
+	node.mass = total;
+	for (int j = 0; j < 3; j++)
+	{
+		node.massCenter[j] = total > 0.0 ? weighted[j] / total : center[j];
+	}
+}
+
+void GravitySimulation::accelerateRange(int begin, int end)
+{
+	double theta2 = (double)theta * theta;
+	int stack[maxDepth * 8 + 8];
+
+	// what pulls the bodies of a group, groups of bodies and single bodies in one list
+	// positions are relative to the group, so floats are precise enough
+	std::vector<float> px, py, pz, pm;
+
+	for (int g = begin; g < end; g++)
+	{
+		const Node& group = nodes[groups[g]];
+
+		// the box around the bodies of the group
+		double low[3] = {1e300, 1e300, 1e300}, high[3] = {-1e300, -1e300, -1e300};
+		for (int k = group.first; k < group.first + group.count; k++)
+		{
+			int i = order[k];
+			low[0] = fmin(low[0], x[i]); high[0] = fmax(high[0], x[i]);
+			low[1] = fmin(low[1], y[i]); high[1] = fmax(high[1], y[i]);
+			low[2] = fmin(low[2], z[i]); high[2] = fmax(high[2], z[i]);
+		}
+		double origin[3] = {(low[0] + high[0]) * 0.5, (low[1] + high[1]) * 0.5, (low[2] + high[2]) * 0.5};
+
+		px.clear(); py.clear(); pz.clear(); pm.clear();
+		int top = 0;
+		stack[top++] = 0;
+		while (top > 0)
+		{
+			const Node& node = nodes[stack[--top]];
+			if (node.count == 0 || node.mass == 0.0)
+				continue;
+
+			// a node is far enough to pull as one body if it's far from every body of the group,
+			// one that overlaps the group is always opened so it never holds the group's own bodies
+			double gap2 = 0.0;
+			bool overlaps = true;
+			for (int j = 0; j < 3; j++)
+			{
+				double gap = fmax(0.0, fmax(low[j] - node.massCenter[j], node.massCenter[j] - high[j]));
+				gap2 += gap * gap;
+				if (node.center[j] + node.halfSize < low[j] || node.center[j] - node.halfSize > high[j])
+					overlaps = false;
+			}
+			double size = node.halfSize * 2.0;
+			if (node.children >= 0 && !overlaps && size * size < theta2 * gap2)
+			{
+				px.push_back((float)(node.massCenter[0] - origin[0]));
+				py.push_back((float)(node.massCenter[1] - origin[1]));
+				pz.push_back((float)(node.massCenter[2] - origin[2]));
+				pm.push_back((float)node.mass);
+			}
+			else if (node.children < 0)
+			{
+				for (int m = node.first; m < node.first + node.count; m++)
+				{
+					int j = order[m];
+					px.push_back((float)(x[j] - origin[0]));
+					py.push_back((float)(y[j] - origin[1]));
+					pz.push_back((float)(z[j] - origin[2]));
+					pm.push_back((float)mass[j]);
+				}
+			}
+			else
+			{
+				for (int c = 0; c < 8; c++)
+				{
+					stack[top++] = node.children + c;
+				}
+			}
+		}
+
+		// pad the list to whole blocks of four with bodies that have no mass
+		while (px.size() % 4 != 0)
+		{
+			px.push_back(0.0f);
+			py.push_back(0.0f);
+			pz.push_back(0.0f);
+			pm.push_back(0.0f);
+		}
+		for (int k = group.first; k < group.first + group.count; k++)
+		{
+			int i = order[k];
+			float sum[3];
+			pullOf((float)(x[i] - origin[0]), (float)(y[i] - origin[1]), (float)(z[i] - origin[2]), px, py, pz, pm, sum);
+			ax[i] = sum[0];
+			ay[i] = sum[1];
+			az[i] = sum[2];
+		}
+	}
+}
+
+void GravitySimulation::pullOf(float bx, float by, float bz, const std::vector<float>& px, const std::vector<float>& py,
+	const std::vector<float>& pz, const std::vector<float>& pm, float* sum)
+{
+	// a body pulls itself with no force at all, since it's at no distance
+	int pulls = (int)px.size();
+	float soft = (float)softening;
+#ifdef SWM_GRAVITY_SSE
+	// four pulls at a time, the reciprocal square root is refined by one Newton step
+	__m128 sx = _mm_setzero_ps(), sy = _mm_setzero_ps(), sz = _mm_setzero_ps();
+	__m128 x4 = _mm_set1_ps(bx), y4 = _mm_set1_ps(by), z4 = _mm_set1_ps(bz), soft4 = _mm_set1_ps(soft);
+	__m128 half4 = _mm_set1_ps(0.5f), three4 = _mm_set1_ps(3.0f);
+	for (int j = 0; j < pulls; j += 4)
+	{
+		__m128 ex = _mm_sub_ps(_mm_loadu_ps(&px[j]), x4);
+		__m128 ey = _mm_sub_ps(_mm_loadu_ps(&py[j]), y4);
+		__m128 ez = _mm_sub_ps(_mm_loadu_ps(&pz[j]), z4);
+		__m128 e2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)), _mm_add_ps(_mm_mul_ps(ez, ez), soft4));
+		__m128 r = _mm_rsqrt_ps(e2);
+		r = _mm_mul_ps(_mm_mul_ps(half4, r), _mm_sub_ps(three4, _mm_mul_ps(e2, _mm_mul_ps(r, r))));
+		__m128 pull = _mm_mul_ps(_mm_loadu_ps(&pm[j]), _mm_mul_ps(r, _mm_mul_ps(r, r)));
+		sx = _mm_add_ps(sx, _mm_mul_ps(ex, pull));
+		sy = _mm_add_ps(sy, _mm_mul_ps(ey, pull));
+		sz = _mm_add_ps(sz, _mm_mul_ps(ez, pull));
+	}
+	float lanes[3][4];
+	_mm_storeu_ps(lanes[0], sx);
+	_mm_storeu_ps(lanes[1], sy);
+	_mm_storeu_ps(lanes[2], sz);
+	for (int c = 0; c < 3; c++)
+	{
+		sum[c] = lanes[c][0] + lanes[c][1] + lanes[c][2] + lanes[c][3];
+	}
+#else
+	sum[0] = sum[1] = sum[2] = 0.0f;
+	for (int j = 0; j < pulls; j++)
+	{
+		float ex = px[j] - bx, ey = py[j] - by, ez = pz[j] - bz;
+		float e2 = ex * ex + ey * ey + ez * ez + soft;
+		float pull = pm[j] / (e2 * sqrtf(e2));
+		sum[0] += ex * pull;
+		sum[1] += ey * pull;
+		sum[2] += ez * pull;
+	}
+#endif
+}
+
+void GravitySimulation::accelerateExactRange(int begin, int end)
+{
+	int count = (int)x.size();
+	for (int i = begin; i < end; i++)
+	{
+		double px = x[i], py = y[i], pz = z[i];
+		double sx = 0.0, sy = 0.0, sz = 0.0;
+		for (int j = 0; j < count; j++)
+		{
+			if (j == i)
+				continue;
+			double ex = x[j] - px, ey = y[j] - py, ez = z[j] - pz;
+			double e2 = ex * ex + ey * ey + ez * ez + softening;
+			double pull = mass[j] / (e2 * sqrt(e2));
+			sx += ex * pull;
+			sy += ey * pull;
+			sz += ez * pull;
+		}
+		ax[i] = sx;
+		ay[i] = sy;
+		az[i] = sz;
+	}
+}
+
+void GravitySimulation::accelerateTask(void* data, int begin, int end)
+{
+	((GravitySimulation*)data)->accelerateRange(begin, end);
+}
+
+void GravitySimulation::accelerateExactTask(void* data, int begin, int end)
+{
+	((GravitySimulation*)data)->accelerateExactRange(begin, end);
+}
+
+void GravitySimulation::runParallel(RangeFunction function, int count, int grain)
+{
+	if (jobs != NULL)
+		jobs->parallelFor(count, grain, function, this);
+	else
+		function(this, 0, count);
+}
+
+void GravitySimulation::accelerate(bool exact)
+{
+	if (exact)
+	{
+		runParallel(accelerateExactTask, (int)x.size(), forceGrain);
+	}
+	else
+	{
+		buildTree();
+		runParallel(accelerateTask, (int)groups.size(), groupGrain);
+	}
+	accelerated = true;
+}
+
+void GravitySimulation::getAcceleration(int index, double* acceleration)
+{
+	acceleration[0] = ax[index];
+	acceleration[1] = ay[index];
+	acceleration[2] = az[index];
+}
+
+void GravitySimulation::step(double dt)
+{
+	// kick half a step, drift a full step with the new velocities, then kick the other half
+	if (!accelerated)
+		accelerate(false);
+	int count = (int)x.size();
+	double half = dt * 0.5;
+	for (int i = 0; i < count; i++)
+	{
+		vx[i] += ax[i] * half;
+		vy[i] += ay[i] * half;
+		vz[i] += az[i] * half;
+		x[i] += vx[i] * dt;
+		y[i] += vy[i] * dt;
+		z[i] += vz[i] * dt;
+	}
+	accelerate(false);
+	for (int i = 0; i < count; i++)
+	{
+		vx[i] += ax[i] * half;
+		vy[i] += ay[i] * half;
+		vz[i] += az[i] * half;
+	}
+}
+
+void GravitySimulation::potentialTask(void* data, int begin, int end)
+{
+	GravitySimulation* simulation = (GravitySimulation*)data;
+	int count = (int)simulation->x.size();
+	for (int i = begin; i < end; i++)
+	{
+		// every pair is counted once, by its first body
+		double sum = 0.0;
+		for (int j = i + 1; j < count; j++)
+		{
+			double ex = simulation->x[j] - simulation->x[i];
+			double ey = simulation->y[j] - simulation->y[i];
+			double ez = simulation->z[j] - simulation->z[i];
+			sum -= simulation->mass[i] * simulation->mass[j] / sqrt(ex * ex + ey * ey + ez * ez + simulation->softening);
+		}
+		simulation->potentials[i] = sum;
+	}
+}
+
+double GravitySimulation::getEnergy(void)
+{
+	int count = (int)x.size();
+	potentials.assign(count, 0.0);
+	if (jobs != NULL)
+		jobs->parallelFor(count, forceGrain, potentialTask, this);
+	else
+		potentialTask(this, 0, count);
+
+	// masses are gravitational parameters, so this is the energy divided by G
+	double energy = 0.0;
+	for (int i = 0; i < count; i++)
+	{
+		energy += potentials[i] + 0.5 * mass[i] * (vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i]);
+	}
+	return energy;
+}
+
+void GravitySimulation::getPositions(int first, int count, std::vector<float>& positions)
+{
+	positions.resize(count * 3);
+	for (int i = 0; i < count; i++)
+	{
+		positions[i * 3] = (float)x[first + i];
+		positions[i * 3 + 1] = (float)y[first + i];
+		positions[i * 3 + 2] = (float)z[first + i];
+	}
+}
@@ -0,0 +1,64 @@
+#include "inputlog.h"
+#include <cstdio>
+#include <cstring>
+#include "mappedfile.h"
+
+// The following structure starts a log on the disk, all little-endian.
+// It's followed by the start of the run and the events.
+struct InputLogHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t eventCount;
+	uint32_t frameCount;
+};
+
+static const char inputLogMagic[4] = {'S', 'W', 'M', 'I'};
+
+bool writeInputLog(const char* path, const InputLog& log)
+{
+	InputLogHeader header;
+	memcpy(header.magic, inputLogMagic, sizeof(inputLogMagic));
+	header.version = inputLogVersion;
+	header.eventCount = (uint32_t)log.events.size();
+	header.frameCount = log.frameCount;
+
+	FILE* file = fopen(path, "wb");
+	if (file == NULL)
+		return false;
+	bool written = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(&log.start, sizeof(log.start), 1, file) == 1;
+	if (!log.events.empty())
+		written = fwrite(&log.events[0], sizeof(InputEvent), log.events.size(), file) == log.events.size() && written;
+	written = fclose(file) == 0 && written;
+	return written;
+}
+
+bool readInputLog(const char* path, InputLog* log)
+{
+	MappedFile file;
+	if (!file.open(path))
+		return false;
+	const unsigned char* data = file.getData();
+	size_t size = file.getSize();
+
+	if (size < sizeof(InputLogHeader) + sizeof(InputStart))
+		return false;
+	const InputLogHeader* header = (const InputLogHeader*)data;
+	if (memcmp(header->magic, inputLogMagic, sizeof(inputLogMagic)) != 0 || header->version != inputLogVersion ||
+		size != sizeof(InputLogHeader) + sizeof(InputStart) + header->eventCount * (uint64_t)sizeof(InputEvent))
+		return false;
+
+	// events come in the order of their frames, all within the run
+	const InputEvent* events = (const InputEvent*)(data + sizeof(InputLogHeader) + sizeof(InputStart));
+	for (uint32_t i = 0; i < header->eventCount; i++)
+	{
+		if (events[i].type > INPUT_MOUSE || events[i].frame > header->frameCount ||
+			(i > 0 && events[i].frame < events[i - 1].frame))
+			return false;
+	}
+
+	memcpy(&log->start, data + sizeof(InputLogHeader), sizeof(InputStart));
+	log->events.assign(events, events + header->eventCount);
+	log->frameCount = header->frameCount;
+	return true;
+}
@@ -0,0 +1,302 @@
+#include "jobsystem.h"
+
+// the queue of the current thread in the job system it's a worker of, other job systems use queue 0 on it
+static thread_local JobSystem* queueOwner = NULL;
+static thread_local int queueIndex = 0;
+
+// tasks running on the current thread, busy time is only counted at the outermost
+static thread_local int taskDepth = 0;
+
+// pieces a parallel loop is cut into for every thread, so faster threads can take more
+static const int piecesPerThread = 4;
+
+static int64_t elapsedNanoseconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+JobSystem::JobSystem(int threadCount)
+{
+	if (threadCount <= 0)
+		threadCount = (int)std::thread::hardware_concurrency();
+	if (threadCount < 1)
+		threadCount = 1;
+	stopping = false;
+	queued = 0;
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		Queue* queue = new Queue;
+		queue->busy = 0;
+		queues.push_back(queue);
+	}
+	lastBusy.assign(threadCount, 0);
+	measured = std::chrono::steady_clock::now();
+	for (int i = 1; i < threadCount; i++)
+	{
+		workers.push_back(std::thread(&JobSystem::run, this, i));
+	}
+}
+
+JobSystem::~JobSystem(void)
+{
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (int i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+	for (int i = 0; i < queues.size(); i++)
+	{
+		delete queues[i];
+	}
+}
+
+int JobSystem::getThreadCount(void)
+{
+	return (int)queues.size();
+}
+
+int JobSystem::currentQueue(void)
+{
+	return queueOwner == this && queueIndex < queues.size() ? queueIndex : 0;
+}
+
+void JobSystem::run(int index)
+{
+	queueOwner = this;
+	queueIndex = index;
+	while (true)
+	{
+		if (runOne(index))
+			continue;
+
+		// sleep until there is something to do
+		std::unique_lock<std::mutex> guard(sleepLock);
+		while (queued == 0 && !stopping)
+		{
+			wake.wait(guard);
+		}
+		if (stopping)
+			return;
+	}
+}
+
+bool JobSystem::runOne(int index)
+{
+	Task task;
+	bool found = false;
+
+	// newest from the own queue, it's most likely still in the cache
+	{
+		Queue* own = queues[index];
+		std::lock_guard<std::mutex> guard(own->lock);
+		if (!own->tasks.empty())
+		{
+			task = own->tasks.back();
+			own->tasks.pop_back();
+			found = true;
+		}
+	}
+
+	// oldest from the others, it's most likely the biggest piece of work left
+	for (int i = 1; !found && i < queues.size(); i++)
+	{
+		Queue* victim = queues[(index + i) % queues.size()];
+		std::lock_guard<std::mutex> guard(victim->lock);
+		if (!victim->tasks.empty())
+		{
+			task = victim->tasks.front();
+			victim->tasks.pop_front();
+			found = true;
+		}
+	}
+	if (!found)
+		return false;
+
+	queued--;
+	execute(index, task);
+	return true;
+}
+
+void JobSystem::execute(int index, Task& task)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	taskDepth++;
+	task.function(task.data, task.begin, task.end);
+	taskDepth--;
+	if (taskDepth == 0)
+		queues[index]->busy += elapsedNanoseconds(start);
+	if (task.remaining != NULL && --(*task.remaining) == 0)
+	{
+		// taking the lock makes sure a waiting thread is either asleep or hasn't checked the count yet
+		{
+			std::lock_guard<std::mutex> guard(sleepLock);
+		}
+		finished.notify_all();
+	}
+}
+
+void JobSystem::push(RangeFunction function, void* data, int begin, int end, std::atomic<int>* remaining)
+{
+	Task task;
+	task.function = function;
+	task.data = data;
+	task.begin = begin;
+	task.end = end;
+	task.remaining = remaining;
+
+	// counted before it can be taken, so the count never drops below zero
+	queued++;
+	Queue* queue = queues[currentQueue()];
+	{
+		std::lock_guard<std::mutex> guard(queue->lock);
+		queue->tasks.push_back(task);
+	}
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+	}
+	wake.notify_one();
+	finished.notify_all();
+}
+
+void JobSystem::wait(std::atomic<int>* remaining)
+{
+	int index = currentQueue();
+	while (*remaining > 0)
+	{
+		if (runOne(index))
+			continue;
+
+		// the last tasks are running on other threads, sleep until they are done or there is more to do
+		std::unique_lock<std::mutex> guard(sleepLock);
+		while (*remaining > 0 && queued == 0)
+		{
+			finished.wait(guard);
+		}
+	}
+}
+
+void JobSystem::parallelFor(int count, int grain, RangeFunction function, void* data)
+{
+	if (count <= 0)
+		return;
+	if (grain < 1)
+		grain = 1;
+	int pieces = (count + grain - 1) / grain;
+	if (pieces > getThreadCount() * piecesPerThread)
+		pieces = getThreadCount() * piecesPerThread;
+	if (pieces <= 1)
+	{
+		function(data, 0, count);
+		return;
+	}
+
+	// the calling thread takes the first piece itself
+	std::atomic<int> remaining(pieces - 1);
+	for (int i = 1; i < pieces; i++)
+	{
+		push(function, data, (int)((int64_t)count * i / pieces), (int)((int64_t)count * (i + 1) / pieces), &remaining);
+	}
+	int index = currentQueue();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	taskDepth++;
+	function(data, 0, count / pieces);
+	taskDepth--;
+	if (taskDepth == 0)
+		queues[index]->busy += elapsedNanoseconds(start);
+	wait(&remaining);
+}
+
+void JobSystem::getUtilization(std::vector<float>& utilization)
+{
+	int64_t elapsed = elapsedNanoseconds(measured);
+	measured = std::chrono::steady_clock::now();
+	utilization.resize(queues.size());
+	for (int i = 0; i < queues.size(); i++)
+	{
+		int64_t busy = queues[i]->busy;
+		utilization[i] = elapsed > 0 ? (float)(busy - lastBusy[i]) / elapsed : 0.0f;
+		lastBusy[i] = busy;
+	}
+}
+
+JobGraph::JobGraph(JobSystem* jobs)
+{
+	this->jobs = jobs;
+	remaining = 0;
+}
+
+JobGraph::~JobGraph(void)
+{
+	for (int i = 0; i < nodes.size(); i++)
+	{
+		delete nodes[i];
+	}
+}
+
+int JobGraph::add(JobFunction function, void* data, int dependency, int otherDependency)
+{
+	int index = (int)nodes.size();
+	Node* node = new Node;
+	node->function = function;
+	node->data = data;
+	node->waiting = 0;
+	if (dependency >= 0 && dependency < index)
+	{
+		nodes[dependency]->dependants.push_back(index);
+		node->waiting++;
+	}
+	if (otherDependency >= 0 && otherDependency < index && otherDependency != dependency)
+	{
+		nodes[otherDependency]->dependants.push_back(index);
+		node->waiting++;
+	}
+	nodes.push_back(node);
+	return index;
+}
+
+void JobGraph::runNode(void* data, int begin, int end)
+{
+	JobGraph* graph = (JobGraph*)data;
+	Node* node = graph->nodes[begin];
+	node->function(node->data);
+
+	// start the jobs that were only waiting for this one
+	for (int i = 0; i < node->dependants.size(); i++)
+	{
+		int dependant = node->dependants[i];
+		if (--graph->nodes[dependant]->waiting == 0)
+			graph->jobs->push(runNode, graph, dependant, dependant + 1, &graph->remaining);
+	}
+}
+
+void JobGraph::run(void)
+{
+	// jobs are in topological order already
+	if (jobs == NULL)
+	{
+		for (int i = 0; i < nodes.size(); i++)
+		{
+			nodes[i]->function(nodes[i]->data);
+		}
+		return;
+	}
+
+	// find the jobs to start with before any of them runs and starts the others
+	std::vector<int> roots;
+	for (int i = 0; i < nodes.size(); i++)
+	{
+		if (nodes[i]->waiting == 0)
+			roots.push_back(i);
+	}
+	remaining = (int)nodes.size();
+	for (int i = 0; i < roots.size(); i++)
+	{
+		jobs->push(runNode, this, roots[i], roots[i] + 1, &remaining);
+	}
+	jobs->wait(&remaining);
+}
@@ -0,0 +1,217 @@
+#include "kepler.h"
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SWM_KEPLER_SSE
+#endif
+
+// Newton steps from the last solve, and from scratch
+static const int warmSteps = 2;
+static const int coldSteps = 6;
+
+// the mean anomaly may move this far between solves and still start from the last one,
+// times the square of 1 - e, as E races past the closest point of narrow orbits
+static const float warmLimit = 0.5f;
+
+static const float twoPi = 2.0f * pi;
+
+#ifdef SWM_KEPLER_SSE
+// sine and cosine of four angles of at most a few turns
+// the angle is brought to within an eighth of a turn of a multiple of a quarter turn, where short polynomials are exact to a float
+static void sinCos(__m128 x, __m128* sine, __m128* cosine)
+{
+	__m128i quarter = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(2.0f / pi)));
+	__m128 q = _mm_cvtepi32_ps(quarter);
+
+	// take the quarter turns away in three parts, so little is lost to rounding
+	x = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(1.5703125f)));
+	x = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(4.837512969970703125e-4f)));
+	x = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(7.54978995489188216e-8f)));
+
+	__m128 x2 = _mm_mul_ps(x, x);
+	__m128 s = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), x2), _mm_set1_ps(8.3321608736e-3f));
+	s = _mm_add_ps(_mm_mul_ps(s, x2), _mm_set1_ps(-1.6666654611e-1f));
+	s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, x2), x), x);
+	__m128 c = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), x2), _mm_set1_ps(-1.388731625493765e-3f));
+	c = _mm_add_ps(_mm_mul_ps(c, x2), _mm_set1_ps(4.166664568298827e-2f));
+	c = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(c, x2), x2), _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(x2, _mm_set1_ps(0.5f))));
+
+	// odd quarters swap sine and cosine, the signs follow the half turns
+	__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quarter, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+	__m128 sineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quarter, _mm_set1_epi32(2)), 30));
+	__m128 cosineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quarter, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+	*sine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s)), sineSign);
+	*cosine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c)), cosineSign);
+}
+
+// the angle moved by whole turns to between minus and plus half a turn, with the turns taken
+static __m128 wrap(__m128 angle, __m128* turns)
+{
+	*turns = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(angle, _mm_set1_ps(1.0f / twoPi))));
+	return _mm_sub_ps(angle, _mm_mul_ps(*turns, _mm_set1_ps(twoPi)));
+}
+#else
+static float wrap(float angle, float* turns)
+{
+	*turns = floorf(angle / twoPi + 0.5f);
+	return angle - *turns * twoPi;
+}
+#endif
+
+KeplerSolver::KeplerSolver(void)
+{
+	count = 0;
+}
+
+int KeplerSolver::add(float eccentricity)
+{
+	// a new block of four starts out as circles
+	if (count % 4 == 0)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			eccentricities.push_back(0.0f);
+			lastMean.push_back(0.0f);
+			lastEccentric.push_back(0.0f);
+			meanAnomalies.push_back(0.0f);
+			sines.push_back(0.0f);
+			cosines.push_back(1.0f);
+		}
+		solved.push_back(false);
+	}
+	eccentricities[count] = eccentricity;
+	solved[count / 4] = false;
+	return count++;
+}
+
+void KeplerSolver::reserve(int count)
+{
+	int padded = (count + 3) & ~3;
+	eccentricities.reserve(padded);
+	lastMean.reserve(padded);
+	lastEccentric.reserve(padded);
+	meanAnomalies.reserve(padded);
+	sines.reserve(padded);
+	cosines.reserve(padded);
+	solved.reserve(padded / 4);
+}
+
+int KeplerSolver::size(void) const
+{
+	return count;
+}
+
+void KeplerSolver::reset(void)
+{
+	for (int i = 0; i < solved.size(); i++)
+	{
+		solved[i] = false;
+	}
+}
+
+void KeplerSolver::solve(void)
+{
+	for (int block = 0; block < solved.size(); block++)
+	{
+		solveBlock(block);
+	}
+}
+
+void KeplerSolver::solveBlock(int block)
+{
+	int first = block * 4;
+#ifdef SWM_KEPLER_SSE
+	__m128 e = _mm_loadu_ps(&eccentricities[first]);
+	__m128 one = _mm_set1_ps(1.0f);
+	__m128 turns;
+	__m128 mean = wrap(_mm_loadu_ps(&meanAnomalies[first]), &turns);
+	__m128 eccentric;
+
+	// how far the mean anomalies moved since the last solve, the short way round
+	__m128 last = _mm_loadu_ps(&lastMean[first]);
+	__m128 moved = wrap(_mm_sub_ps(mean, last), &turns);
+	__m128 slack = _mm_sub_ps(one, e);
+	__m128 far = _mm_cmpge_ps(_mm_max_ps(moved, _mm_sub_ps(_mm_setzero_ps(), moved)),
+		_mm_mul_ps(_mm_set1_ps(warmLimit), _mm_mul_ps(slack, slack)));
+	int steps;
+	if (solved[block] && _mm_movemask_ps(far) == 0)
+	{
+		// go on from the last solution, moved as fast as E moves for M there, and on the same turn as it
+		__m128 lastCosine = _mm_loadu_ps(&cosines[first]);
+		eccentric = _mm_add_ps(_mm_loadu_ps(&lastEccentric[first]),
+			_mm_div_ps(moved, _mm_sub_ps(one, _mm_mul_ps(e, lastCosine))));
+		mean = _mm_add_ps(last, moved);
+		steps = warmSteps;
+	}
+	else
+	{
+		// start a little ahead of M towards the far end of the ellipse, which always converges
+		__m128 sign = _mm_and_ps(mean, _mm_castsi128_ps(_mm_set1_epi32(0x80000000)));
+		eccentric = _mm_add_ps(mean, _mm_or_ps(_mm_mul_ps(e, _mm_set1_ps(0.85f)), sign));
+		steps = coldSteps;
+	}
+
+	// E is never further than e from M, which keeps the steps from running away close to the sun
+	__m128 low = _mm_sub_ps(mean, e), high = _mm_add_ps(mean, e);
+	__m128 sine, cosine;
+	for (int step = 0; step < steps; step++)
+	{
+		eccentric = _mm_min_ps(_mm_max_ps(eccentric, low), high);
+		sinCos(eccentric, &sine, &cosine);
+		__m128 error = _mm_sub_ps(_mm_sub_ps(eccentric, _mm_mul_ps(e, sine)), mean);
+		eccentric = _mm_sub_ps(eccentric, _mm_div_ps(error, _mm_sub_ps(one, _mm_mul_ps(e, cosine))));
+	}
+	sinCos(eccentric, &sine, &cosine);
+	_mm_storeu_ps(&sines[first], sine);
+	_mm_storeu_ps(&cosines[first], cosine);
+
+	// keep both anomalies within half a turn, so they never grow out of precision
+	mean = wrap(mean, &turns);
+	eccentric = _mm_sub_ps(eccentric, _mm_mul_ps(turns, _mm_set1_ps(twoPi)));
+	_mm_storeu_ps(&lastMean[first], mean);
+	_mm_storeu_ps(&lastEccentric[first], eccentric);
+#else
+	float turns;
+	float mean[4], eccentric[4];
+	bool warm = solved[block];
+	for (int i = 0; i < 4; i++)
+	{
+		float slack = 1.0f - eccentricities[first + i];
+		mean[i] = wrap(meanAnomalies[first + i], &turns);
+		if (fabs(wrap(mean[i] - lastMean[first + i], &turns)) >= warmLimit * slack * slack)
+			warm = false;
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		int k = first + i;
+		float e = eccentricities[k];
+		if (warm)
+		{
+			float moved = wrap(mean[i] - lastMean[k], &turns);
+			eccentric[i] = lastEccentric[k] + moved / (1.0f - e * cosines[k]);
+			mean[i] = lastMean[k] + moved;
+		}
+		else
+		{
+			eccentric[i] = mean[i] + (mean[i] < 0.0f ? -0.85f : 0.85f) * e;
+		}
+		for (int step = 0; step < (warm ? warmSteps : coldSteps); step++)
+		{
+			eccentric[i] = fmin(fmax(eccentric[i], mean[i] - e), mean[i] + e);
+			eccentric[i] -= (eccentric[i] - e * sinf(eccentric[i]) - mean[i]) / (1.0f - e * cosf(eccentric[i]));
+		}
+		sines[k] = sinf(eccentric[i]);
+		cosines[k] = cosf(eccentric[i]);
+		lastMean[k] = wrap(mean[i], &turns);
+		lastEccentric[k] = eccentric[i] - turns * twoPi;
+	}
+#endif
+	solved[block] = true;
+}
+
+size_t KeplerSolver::getMemoryFootprint(void) const
+{
+	return (eccentricities.capacity() + lastMean.capacity() + lastEccentric.capacity() + meanAnomalies.capacity() +
+		sines.capacity() + cosines.capacity()) * sizeof(float) + solved.capacity() / 8;
+}
@@ -5,21 +5,42 @@
 #endif
 #include <glut.h>
 
-#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <algorithm>
 #include "tga.h"
 #include "solarsystem.h"
 #include "camera.h"
 #include "globals.h"
-#include "wormhole.h"
+#include "savegame.h"
+#include "autosaver.h"
+#include "destinationbuilder.h"
+#include "systemcache.h"
+#include "catalog.h"
+#include "universe.h"
+#include "random.h"
+#include "jobsystem.h"
+#include "gravity.h"
+#include "glextensions.h"
+#include "trails.h"
+#include "profiler.h"
+#include "metrics.h"
+#include "overlay.h"
+#include "inputlog.h"
+#include "perftest.h"
+#include "autopilot.h"
+#include "glcount.h"
 
 // screen size
 int screenWidth, screenHeight;
 
 // The TGA texture containing the help dialogue, the starfield, planet texture and spaceship texture.
+// Textures of the known systems are loaded as the catalog names them.
 TGA *window, *stars;
-TGA *sun, *mercury, *venus, *earth, *mars, *jupiter, *saturn, *uranus, *neptune, *pluto, *wormhole_pic;
-TGA *other_planets[11], *sunPic[3];
-TGA *moon, *topSafe, *topFrame, *topDanger, *crashed, *vertical, *horizontal, 
+TGA *wormhole_pic;
+TGA *other_planets[12], *sunPic[3];
+TGA *topSafe, *topFrame, *topDanger, *crashed, *vertical, *horizontal, 
 	*black, *control, *mirror, *mirrorMid;
 
 // starship view
@@ -28,6 +49,18 @@ bool starshipView = true;
 // orbits are drawn
 bool showOrbits = true;
 
+// trails behind the spaceship and the bodies, a point is taken every few frames,
+// the bodies of the system and then the asteroids get one trail each as long as there are trails left
+TrailSet* shipTrail = NULL;
+TrailSet* bodyTrails = NULL;
+bool showTrails = true;
+const int trailLength = 128;
+const int trailInterval = 3;
+const int maxBodyTrails = 2048;
+int trailFrame = 0;
+SolarSystem* trailedSystem = NULL;
+int trailedBodies = 0;
+
 // set the initial focus of the spaceship to be the Sun
 int planetSelected = 1;
 
@@ -35,9 +68,12 @@ int planetSelected = 1;
 bool fellDown = false;
 
 // these control the elapse of time
-double time;
+SimulationTime simulationTime;
 double timeSpeed;
 
+// days a frame may warp at most, a billion times the normal speed
+const double maxTimeSpeed = 1e8;
+
 // state of the controls for the camera
 struct ControlStates
 {
@@ -47,25 +83,363 @@ struct ControlStates
 Camera camera;
 SolarSystem *galaxy;
 
+// the catalog of known systems, compiled from its source at the start unless another catalog is given
+Catalog* catalog;
+const char* catalogPath = "data/systems.cat";
+const char* catalogSource = "data/systems.txt";
+
+// random systems are generated from seeds, the system behind the wormhole is
+// built in the background from this distance on
+SystemGenerator* generator;
+DestinationBuilder* builder;
+const float approachDistance = 1.0f;
+SolarSystem* residentDestination = NULL;
+
+// ids of the current system, of the one the wormhole leads to and of those visited before
+uint64_t currentSystemId = 0;
+uint64_t destinationId = 0;
+bool destinationChosen = false;
+std::vector<uint64_t> visitedSystems;
+const int maxVisitedSystems = 64;
+
+// recently visited systems are kept within a budget in bytes
+SystemCache* cache;
+size_t cacheBudget = 64 * 1024 * 1024;
+
+// the open universe, only there when asked for on the command line,
+// its wormholes lead to a random faraway sector
+Universe* universe = NULL;
+bool universeMode = false;
+uint64_t universeSeed = 0;
+const int wormholeReach = 1000;
+int targetSector[3];
+
+// the spaceship went into a wormhole of the open universe, and is moved once the sector on the other side is built
+bool jumpPending = false;
+
+// the work of every frame is spread over this many threads, all cores if 0
+JobSystem* jobs = NULL;
+int jobThreads = 0;
+
+// in gravity mode the bodies, the spaceship and a belt of asteroids pull on each other
+// instead of following their orbits, only for systems outside the open universe
+GravitySimulation* gravity = NULL;
+bool gravityMode = false;
+int asteroidCount = 0;
+float gravityTheta = 0.7f;
+int shipBody = 0;
+std::vector<float> asteroidPositions;
+
+// the longest step of the simulation in days, and the most steps in a frame
+const double maxGravityStep = 0.5;
+const int maxGravitySteps = 4;
+
+// the phases of the latest frames are kept for a trace, written with 'x' and at the exit when a path is given
+Profiler* profiler = NULL;
+const int profileEvents = 65536;
+const char* tracePath = "trace.json";
+bool traceAtExit = false;
+
+// metrics are written there every interval in ms when a path is given,
+// the percentiles of the frame time are taken over the latest frames
+const char* statsPath = NULL;
+const int statsInterval = 10000;
+int lastStats = 0;
+int64_t lastFrameStart = 0;
+const int recentFrameCount = 1024;
+std::vector<double> recentFrames;
+int recentFrameNext = 0;
+
+// flies the ship to the selected planet, planning on all cores
+Autopilot* autopilot = NULL;
+
+// how the last flight of the autopilot ended, shown on the overlay until it's engaged again
+const char* autopilotStatus = "";
+
+// the overlay of numbers and the graph of the latest frame times
+Overlay* overlay = NULL;
+bool showOverlay = false;
+const int graphFrames = 128;
+
+// the input of a run is recorded into a log written at the exit, or fed back from one frame by frame,
+// live input is ignored while a replay runs
+const char* recordPath = NULL;
+const char* replayPath = NULL;
+InputLog inputLog;
+bool replaying = false;
+size_t replayNext = 0;
+uint32_t inputFrame = 0;
+
+// the performance test renders every scene headlessly after a few frames to settle,
+// and the program exits with 1 if any scene is over its budgets
+bool perfTestMode = false;
+PerfTest* perfTest = NULL;
+int perfScene = 0, perfFrame = 0;
+bool perfPassed = true;
+const int perfWarmupFrames = 20;
+const int perfMeasuredFrames = 100;
+
+// headless runs render a fixed number of frames in a hidden window and then quit
+bool headless = false;
+int headlessFrames = 0;
+
+// size of the poster, it's a multiple of the window size if not given
+const int posterScale = 4;
+int posterWidth = 0, posterHeight = 0;
+bool posterRequested = false;
+
+// saves are written by a background thread into rotating slots, automatically every interval in ms
+AutoSaver* saver;
+const int saveSlots = 3;
+const int autosaveInterval = 60000;
+int lastAutosave = 0;
+
 // save the galaxy and the camera, saving the current status
 void saveModel(void)
 {
-	std::ofstream outfile("status.dat", std::ios::binary | std::ios::out);
-	outfile.write((char *)galaxy, sizeof(SolarSystem));
-	outfile.write((char *)&camera, sizeof(camera));
-	outfile.close();
+	// only a flat copy is taken here, the file is written in the background
+	SaveSnapshot* snapshot = saver->begin();
+	snapshot->state.time = simulationTime.get();
+	snapshot->state.timeSpeed = timeSpeed;
+	snapshot->state.systemId = currentSystemId;
+	snapshot->state.planetSelected = planetSelected;
+	snapshot->state.sector[0] = snapshot->state.sector[1] = snapshot->state.sector[2] = 0;
+	if (universe != NULL)
+		universe->getSector(snapshot->state.sector);
+	camera.getState(&snapshot->camera);
+	galaxy->describe(snapshot->bodies);
+	nameTextures(snapshot);
+	saver->submit(snapshot);
+}
+
+// set up the simulation for the current system, starting from where the bodies are now
+void startGravity(void)
+{
+	delete gravity;
+	gravity = new GravitySimulation(jobs);
+	gravity->setTheta(gravityTheta);
+
+	std::vector<GravityBody> states;
+	galaxy->getGravityBodies(simulationTime, states);
+	double sunMass = 0.0;
+	for (int i = 0; i < states.size(); i++)
+	{
+		gravity->add(states[i]);
+		if (states[i].mass > sunMass)
+			sunMass = states[i].mass;
+	}
+
+	// the spaceship is pulled but doesn't pull
+	GravityBody ship = {{0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}, 0.0};
+	float position[3];
+	camera.getPosition(position);
+	for (int i = 0; i < 3; i++)
+	{
+		ship.position[i] = position[i];
+	}
+	shipBody = gravity->add(ship);
+
+	// the belt lies between the fourth and the fifth planet, or outside the last one
+	std::vector<BodyDesc> bodies;
+	std::vector<float> distances;
+	galaxy->describe(bodies);
+	for (int i = 0; i < bodies.size(); i++)
+	{
+		if (bodies[i].kind == BODY_PLANET && bodies[i].distance > 0.001f)
+			distances.push_back(bodies[i].distance * distanceScale);
+	}
+	std::sort(distances.begin(), distances.end());
+	if (asteroidCount > 0 && !distances.empty())
+	{
+		double inner = distances.back() * 1.2, outer = distances.back() * 1.6;
+		if (distances.size() >= 5)
+		{
+			inner = distances[3] * 1.1;
+			outer = distances[4] * 0.9;
+		}
+		gravity->addRing(asteroidCount, inner, outer, sunMass, sunMass * 1e-6, currentSystemId);
+	}
+	gravity->removeDrift();
+	bodyTrails->clear(0, bodyTrails->getTrailCount());
+}
+
+// go back to the fixed orbits, dropping the asteroids
+void stopGravity(void)
+{
+	delete gravity;
+	gravity = NULL;
+	asteroidPositions.clear();
+	bodyTrails->clear(0, bodyTrails->getTrailCount());
+}
+
+// move everything in the simulation forward by the time of a frame, the spaceship included
+void stepGravity(void)
+{
+	int steps = (int)ceil(timeSpeed / maxGravityStep);
+	if (steps < 1)
+		steps = 1;
+	if (steps > maxGravitySteps)
+		steps = maxGravitySteps;
+
+	// the spaceship steers itself, gravity only adds to that
+	float position[3];
+	double shipPosition[3];
+	camera.getPosition(position);
+	for (int i = 0; i < 3; i++)
+	{
+		shipPosition[i] = position[i];
+	}
+	gravity->setPosition(shipBody, shipPosition);
+	for (int i = 0; i < steps; i++)
+	{
+		gravity->step(timeSpeed / steps);
+	}
+
+	GravityBody ship;
+	gravity->getBody(shipBody, &ship);
+	float drift[3];
+	for (int i = 0; i < 3; i++)
+	{
+		drift[i] = (float)(ship.position[i] - shipPosition[i]);
+	}
+	camera.shift(drift);
+
+	galaxy->placeBodies(*gravity, 0, simulationTime);
+	gravity->getPositions(shipBody + 1, gravity->getBodyCount() - shipBody - 1, asteroidPositions);
 }
 
-// load the galaxy and the camera, restoring the status
+// load the galaxy and the camera from the newest save, restoring the status
 void loadModel(void)
 {
-	std::ifstream infile("status.dat", std::ios::binary | std::ios::in);
-	if (infile.is_open())
+	SaveSnapshot snapshot;
+	if (!saver->loadLatest(&snapshot))
+		return;
+
+	// sectors of the open universe are rebuilt from their seeds
+	if (universe != NULL)
+	{
+		universe->moveTo(snapshot.state.sector);
+		galaxy = universe->getCurrentSystem();
+	}
+	else
+	{
+		builder->retire(galaxy);
+		galaxy = new SolarSystem(snapshot.bodies);
+		currentSystemId = snapshot.state.systemId;
+	}
+	camera.setState(&snapshot.camera);
+	shipTrail->clear(0, 1);
+	bodyTrails->clear(0, bodyTrails->getTrailCount());
+	simulationTime.set(snapshot.state.time);
+	timeSpeed = snapshot.state.timeSpeed;
+	if (timeSpeed > maxTimeSpeed)
+		timeSpeed = maxTimeSpeed;
+	planetSelected = snapshot.state.planetSelected;
+	fellDown = false;
+	destinationChosen = false;
+	jumpPending = false;
+	if (gravity != NULL)
+		startGravity();
+}
+
+// move to the system with the id, taking it from the cache if it was visited recently
+void jumpTo(uint64_t id)
+{
+	camera.reset();
+	shipTrail->clear(0, 1);
+	destinationChosen = false;
+	residentDestination = NULL;
+	if (id == currentSystemId)
+	{
+		if (gravity != NULL)
+			startGravity();
+		return;
+	}
+
+	SolarSystem* next = cache->take(id);
+	if (next == NULL)
+		next = builder->take(id);
+	next->makeResident();
+
+	// the system left behind is kept for a later visit
+	std::vector<SolarSystem*> evicted;
+	cache->put(currentSystemId, galaxy, evicted);
+	for (int i = 0; i < evicted.size(); i++)
+	{
+		builder->retire(evicted[i]);
+	}
+	galaxy = next;
+	currentSystemId = id;
+	if (gravity != NULL)
+		startGravity();
+}
+
+// take the percentiles of the latest frames
+void updateFramePercentiles(void)
+{
+	if (recentFrames.empty())
+		return;
+	std::vector<double> sorted(recentFrames);
+	std::sort(sorted.begin(), sorted.end());
+	frameSecondsMedian.set(sorted[sorted.size() / 2]);
+	frameSecondsP99.set(sorted[(sorted.size() * 99) / 100]);
+}
+
+// the calls counted by glcount.h up to the last frame
+GLCallCounts reportedCalls = {0, 0, 0};
+
+// add the draw calls and texture binds of the last frame to the metrics
+void reportCalls(void)
+{
+	drawCalls.add(glCalls.drawCalls - reportedCalls.drawCalls);
+	textureBinds.add(glCalls.textureBinds - reportedCalls.textureBinds);
+	reportedCalls = glCalls;
+}
+
+// write the metrics, with the percentiles of the latest frames
+void writeStats(void)
+{
+	updateFramePercentiles();
+	writeMetrics(statsPath);
+}
+
+// finish pending work before the program exits
+void shutdown(void)
+{
+	if (traceAtExit && profiler->writeTrace(tracePath))
+		printf("trace written to %s\n", tracePath);
+	if (statsPath != NULL)
+		writeStats();
+	if (recordPath != NULL)
 	{
-		infile.read((char *)galaxy, sizeof(SolarSystem));
-		infile.read((char *)&camera, sizeof(camera));
+		inputLog.frameCount = inputFrame;
+		if (writeInputLog(recordPath, inputLog))
+			printf("input of %u frames recorded to %s\n", inputFrame, recordPath);
 	}
-	infile.close();
+	delete saver;
+	saver = NULL;
+	delete universe;
+	universe = NULL;
+	delete gravity;
+	gravity = NULL;
+	delete shipTrail;
+	shipTrail = NULL;
+	delete bodyTrails;
+	bodyTrails = NULL;
+	delete jobs;
+	jobs = NULL;
+	delete profiler;
+	profiler = NULL;
+	delete overlay;
+	overlay = NULL;
+	delete cache;
+	cache = NULL;
+	delete builder;
+	builder = NULL;
+	delete generator;
+	generator = NULL;
+	delete catalog;
+	catalog = NULL;
 }
 
 // timer function called every 10ms or more
@@ -108,12 +482,19 @@ void init(void)
 	glEnable(GL_LIGHT0);
 	glDisable(GL_LIGHTING);
 
+	// what the driver offers past OpenGL 1.1
+	loadGLExtensions();
+	profiler = new Profiler(profileEvents);
+	profiler->nameThread("main");
+	overlay = new Overlay(2.0f);
+	shipTrail = new TrailSet(1, trailLength);
+	bodyTrails = new TrailSet(maxBodyTrails, trailLength);
+
 	// load all image data
 
 	// load the spaceship
 	window = new TGA("images/window.tga");
 	stars = new TGA("images/stars.tga");
-	moon = new TGA("images/moon.tga");
 	topSafe = new TGA("images/topSafe.tga");
 	topFrame = new TGA("images/topFrame.tga");
 	topDanger = new TGA("images/topDanger.tga");
@@ -125,37 +506,76 @@ void init(void)
 	mirror = new TGA("images/mirror.tga");
 	mirrorMid = new TGA("images/mirrorMid.tga");
 
-	// load planets
-	sun = new TGA("images/sun.tga");
-	mercury = new TGA("images/mercury.tga");
-	venus = new TGA("images/venus.tga");
-	earth = new TGA("images/earth.tga");
-	mars = new TGA("images/mars.tga");
-	jupiter = new TGA("images/jupiter.tga");
-	saturn = new TGA("images/saturn.tga");
-	uranus = new TGA("images/uranus.tga");
-	neptune = new TGA("images/neptune.tga");
-	pluto = new TGA("images/pluto.tga");
-	wormhole_pic = new TGA("images/black1.tga");
-	other_planets[1] = new TGA("images/1.tga");
-	other_planets[2] = new TGA("images/2.tga");
-	other_planets[3] = new TGA("images/3.tga");
-	other_planets[4] = new TGA("images/4.tga");
-	other_planets[5] = new TGA("images/5.tga");
-	other_planets[6] = new TGA("images/6.tga");
-	other_planets[7] = new TGA("images/7.tga");
-	other_planets[8] = new TGA("images/8.tga");
-	other_planets[9] = new TGA("images/9.tga");
-	other_planets[10] = new TGA("images/10.tga");
-	other_planets[11] = new TGA("images/11.tga");
-	sunPic[1] = new TGA("images/sun1.tga");
-	sunPic[2] = new TGA("images/sun2.tga");
-	sunPic[0] = new TGA("images/sun3.tga");
-
-	galaxy = new SolarSystem();
+	// load planets of generated systems
+	wormhole_pic = new TGA(generatedWormholeImage);
+	for (int i = 0; i < generatedPlanetCount; i++)
+	{
+		other_planets[i + 1] = new TGA(generatedPlanetImages[i]);
+	}
+	for (int i = 0; i < generatedSunCount; i++)
+	{
+		sunPic[i] = new TGA(generatedSunImages[i]);
+	}
+
+	saver = new AutoSaver("status", saveSlots);
+	std::vector<GLuint> sunTextures, planetTextures;
+	for (int i = 0; i < generatedSunCount; i++)
+	{
+		sunTextures.push_back(sunPic[i]->getTextureHandle());
+	}
+	for (int i = 1; i <= generatedPlanetCount; i++)
+	{
+		planetTextures.push_back(other_planets[i]->getTextureHandle());
+	}
+	generator = new SystemGenerator(sunTextures, planetTextures, wormhole_pic->getTextureHandle());
+
+	// the known systems come from the catalog, the first of them is where we start
+	catalog = new Catalog();
+	std::string error;
+	if (catalogSource != NULL && !Catalog::compile(catalogSource, catalogPath, &error))
+	{
+		fprintf(stderr, "%s\n", error.c_str());
+		exit(1);
+	}
+	if (!catalog->open(catalogPath) || catalog->getSystemCount() == 0)
+	{
+		fprintf(stderr, "%s is not a valid catalog\n", catalogPath);
+		exit(1);
+	}
+
+	// images named by the catalog are loaded if they haven't been yet
+	std::vector<GLuint> catalogTextures;
+	for (uint32_t i = 0; i < catalog->getAssetCount(); i++)
+	{
+		const char* name = catalog->getAssetName(i);
+		TGA* image = TGA::find(name);
+		FILE* file = image == NULL ? fopen(name, "rb") : NULL;
+		if (file != NULL)
+		{
+			fclose(file);
+			image = new TGA((char*)name);
+		}
+		catalogTextures.push_back(image != NULL ? image->getTextureHandle() : 0);
+	}
+	builder = new DestinationBuilder(generator, catalog, catalogTextures);
+	jobs = new JobSystem(jobThreads);
+	autopilot = new Autopilot(jobs);
+	if (universeMode)
+	{
+		// sectors are built on half as many threads as the frames run on
+		int streamThreads = jobs->getThreadCount() / 2;
+		universe = new Universe(builder, universeSeed, streamThreads > 1 ? streamThreads : 1, jobs);
+		galaxy = universe->getCurrentSystem();
+	}
+	else
+	{
+		galaxy = builder->build(0);
+	}
+	cache = new SystemCache(cacheBudget);
+	atexit(shutdown);
 
 	// set up time
-	time = 2.552f;
+	simulationTime.set(2.552);
 	timeSpeed = 0.1f;
 
 	// set controls
@@ -166,7 +586,30 @@ void init(void)
 	controls.yawLeft = false;
 	controls.yawRight = false;
 
-	timer(0);
+	// a replay starts where its recording did
+	if (replaying)
+	{
+		simulationTime.set(inputLog.start.time);
+		timeSpeed = inputLog.start.timeSpeed;
+		if (universe == NULL && inputLog.start.systemId != currentSystemId)
+			jumpTo(inputLog.start.systemId);
+	}
+	if (recordPath != NULL)
+	{
+		inputLog.start.time = simulationTime.get();
+		inputLog.start.timeSpeed = timeSpeed;
+		inputLog.start.systemId = currentSystemId;
+		inputLog.start.universeSeed = universeSeed;
+		inputLog.start.universeMode = universeMode;
+		inputLog.start.gravityMode = gravityMode;
+		inputLog.start.asteroidCount = asteroidCount;
+		inputLog.start.gravityTheta = gravityTheta;
+		inputLog.events.clear();
+	}
+
+	// gravity starts from where the bodies are at the starting time
+	if (gravityMode && universe == NULL)
+		startGravity();
 }
 
 void drawCube(void)
@@ -206,18 +649,298 @@ void drawCube(void)
 	glEnd();
 }
 
+// draw the skybox and the solar system, the projection is set up by the caller
+void renderScene(void)
+{
+	glLoadIdentity();
+	camera.transformOrientation();
+
+	// draw the skybox
+	{
+		ProfileScope scope(profiler, "skybox", true);
+		glBindTexture(GL_TEXTURE_2D, stars->getTextureHandle());
+		drawCube();
+		verticesSubmitted.add(24);
+	}
+	camera.transformTranslation();
+
+	GLfloat lightPosition[] = {0.0, 0.0, 0.0, 1.0};
+	glLightfv(GL_LIGHT0, GL_POSITION, lightPosition);
+
+	// render the solar system
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_LIGHTING);
+	{
+		ProfileScope scope(profiler, "bodies", true);
+		if (universe != NULL)
+			universe->render();
+		else
+			galaxy->render();
+	}
+	glDisable(GL_LIGHTING);
+
+	// the asteroids are plain points, all drawn at once
+	if (!asteroidPositions.empty())
+	{
+		ProfileScope scope(profiler, "asteroids", true);
+		glDisable(GL_TEXTURE_2D);
+		glColor3f(0.6f, 0.55f, 0.5f);
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glVertexPointer(3, GL_FLOAT, 0, &asteroidPositions[0]);
+		glDrawArrays(GL_POINTS, 0, (GLsizei)(asteroidPositions.size() / 3));
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glColor3f(1.0f, 1.0f, 1.0f);
+		glEnable(GL_TEXTURE_2D);
+	}
+	if (showOrbits)
+	{
+		ProfileScope scope(profiler, "orbits", true);
+		if (universe != NULL)
+			universe->renderOrbits();
+		else
+			galaxy->renderOrbits();
+	}
+	if (showTrails)
+	{
+		ProfileScope scope(profiler, "trails", true);
+		const float bodyColor[3] = {0.4f, 0.6f, 1.0f};
+		const float shipColor[3] = {1.0f, 0.8f, 0.3f};
+		bodyTrails->render(bodyColor);
+		shipTrail->render(shipColor);
+	}
+	glDisable(GL_DEPTH_TEST);
+}
+
+// save a poster of the scene, defaults to a multiple of the window size
+void savePoster(void)
+{
+	int width = posterWidth > 0 ? posterWidth : screenWidth * posterScale;
+	int height = posterHeight > 0 ? posterHeight : screenHeight * posterScale;
+	camera.saveTiledImage(width, height, renderScene);
+}
+
+// jobs of a frame, the distances are written for display to read
+float planetDistance, wormholeDistance;
+
+void moveBodies(void*)
+{
+	ProfileScope scope(profiler, "move bodies");
+	if (universe != NULL)
+		universe->calculatePositions(simulationTime);
+	else if (gravity != NULL)
+		stepGravity();
+	else
+		galaxy->calculatePositions(simulationTime);
+}
+
+void checkPlanets(void*)
+{
+	ProfileScope scope(profiler, "check planets");
+	if (universe != NULL)
+		planetDistance = universe->testDistancewithPlanet(camera);
+	else
+		planetDistance = galaxy->testDistancewithPlanet(camera);
+}
+
+void checkWormholes(void*)
+{
+	ProfileScope scope(profiler, "check wormholes");
+	if (universe != NULL)
+		wormholeDistance = universe->testDistancewithWormhole(camera);
+	else
+		wormholeDistance = galaxy->testDistancewithWormhole(camera);
+}
+
+// write the numbers of the frame and the graph of the latest frame times in the top left corner
+void drawOverlay(float distance)
+{
+	const unsigned char background[4] = {0, 0, 0, 160};
+	const unsigned char white[4] = {255, 255, 255, 255};
+	const unsigned char green[4] = {80, 220, 80, 255};
+	const unsigned char red[4] = {240, 70, 60, 255};
+	const unsigned char gray[4] = {255, 255, 255, 70};
+
+	// the latest frames from the oldest to the newest, in milliseconds
+	float frames[graphFrames];
+	int count = recentFrames.size() < graphFrames ? (int)recentFrames.size() : graphFrames;
+	float total = 0.0f, longest = 0.0f;
+	for (int i = 0; i < count; i++)
+	{
+		int index = (recentFrameNext - count + i + recentFrameCount) % recentFrameCount;
+		if (recentFrames.size() < recentFrameCount)
+			index = (int)recentFrames.size() - count + i;
+		frames[i] = (float)(recentFrames[index] * 1000.0);
+		total += frames[i];
+		if (frames[i] > longest)
+			longest = frames[i];
+	}
+
+	float line = Overlay::letterHeight * 2.0f;
+	float x = 20.0f, y = 50.0f, width = 360.0f, graphHeight = 80.0f;
+	overlay->clear();
+	overlay->rect(x - 10.0f, y - 10.0f, width + 20.0f, line * 5 + graphHeight + 30.0f, background);
+	overlay->print(x, y, white, "frame %6.2f ms  avg %6.2f  max %6.2f", count > 0 ? frames[count - 1] : 0.0f,
+		count > 0 ? total / count : 0.0f, longest);
+	overlay->print(x, y + line, white, "distance %.4f", distance);
+	overlay->print(x, y + line * 2, white, "speed %.4f", camera.getSpeed());
+	overlay->print(x, y + line * 3, white, "time x%.4g", timeSpeed);
+	overlay->print(x, y + line * 4, white, "planet %d  %s", planetSelected, autopilot->isEngaged() ? "autopilot" : autopilotStatus);
+
+	// the graph reaches up to 50 ms, with lines at 60 and 30 frames per second
+	float top = y + line * 5 + 10.0f, maxMs = 50.0f;
+	overlay->graph(x, top, width, graphHeight, frames, count, maxMs, 1000.0f / 30.0f, green, red);
+	overlay->rect(x, top + graphHeight * (1.0f - 1000.0f / 60.0f / maxMs), width, 1.0f, gray);
+	overlay->rect(x, top + graphHeight * (1.0f - 1000.0f / 30.0f / maxMs), width, 1.0f, gray);
+	overlay->render();
+}
+
+// the handlers of the keys, further down
+void applyKeyDown(unsigned char key);
+void applyKeyUp(unsigned char key);
+
+// keep the event for the log, stamped with the frame that handles it
+void recordInput(InputEventType type, unsigned char key, int x, int y)
+{
+	if (recordPath == NULL)
+		return;
+	InputEvent event = {inputFrame, (uint8_t)type, key, (int16_t)x, (int16_t)y, 0};
+	inputLog.events.push_back(event);
+}
+
+// feed the events of this frame from the log, the replay ends after the last frame of the recording
+void replayInput(void)
+{
+	while (replayNext < inputLog.events.size() && inputLog.events[replayNext].frame <= inputFrame)
+	{
+		const InputEvent& event = inputLog.events[replayNext++];
+		if (event.type == INPUT_KEY_DOWN)
+			applyKeyDown(event.key);
+		else if (event.type == INPUT_KEY_UP)
+			applyKeyUp(event.key);
+		else
+			camera.setMouse(event.x, event.y);
+	}
+	if (inputFrame >= inputLog.frameCount)
+	{
+		replaying = false;
+		printf("replay of %u frames finished\n", inputLog.frameCount);
+	}
+}
+
+// take the next point of every trail, the trails of the bodies start over when the system changes
+void sampleTrails(void)
+{
+	ProfileScope scope(profiler, "sample trails");
+	float position[3];
+	camera.getPosition(position);
+	shipTrail->setPoint(0, position);
+	shipTrail->nextSample();
+
+	int bodyCount = galaxy->getBodyCount();
+	int used = bodyCount + (int)(asteroidPositions.size() / 3);
+	if (used > maxBodyTrails)
+		used = maxBodyTrails;
+	if (galaxy != trailedSystem || used != trailedBodies)
+	{
+		bodyTrails->clear(0, maxBodyTrails);
+		trailedSystem = galaxy;
+		trailedBodies = used;
+	}
+	for (int i = 0; i < used; i++)
+	{
+		if (i < bodyCount)
+			galaxy->getBodyPosition(i, position);
+		else
+			memcpy(position, &asteroidPositions[(i - bodyCount) * 3], sizeof(position));
+		bodyTrails->setPoint(i, position);
+	}
+	bodyTrails->nextSample();
+}
 
 void display(void)
 {
-	// update time
-	time += timeSpeed;
-	galaxy->calculatePositions(time);
+	profiler->beginFrame();
+	ProfileScope frameScope(profiler, "frame");
+	if (replaying)
+		replayInput();
+	inputFrame++;
+
+	// the time from the start of the last frame to this one
+	int64_t frameStart = Profiler::now();
+	if (lastFrameStart != 0)
+	{
+		double seconds = (frameStart - lastFrameStart) * 1e-9;
+		frameSeconds.observe(seconds);
+		if (recentFrames.size() < recentFrameCount)
+		{
+			recentFrames.push_back(seconds);
+		}
+		else
+		{
+			recentFrames[recentFrameNext] = seconds;
+			recentFrameNext = (recentFrameNext + 1) % recentFrameCount;
+		}
+	}
+	lastFrameStart = frameStart;
+	framesRendered.add();
+	reportCalls();
+	if (statsPath != NULL)
+	{
+		int now = glutGet(GLUT_ELAPSED_TIME);
+		if (now - lastStats >= statsInterval)
+		{
+			writeStats();
+			lastStats = now;
+		}
+	}
 
-	float min_distance = galaxy->testDistancewithPlanet(camera);
+	// save every once in a while
+	if (!headless)
+	{
+		int now = glutGet(GLUT_ELAPSED_TIME);
+		if (now - lastAutosave >= autosaveInterval)
+		{
+			ProfileScope scope(profiler, "autosave");
+			saveModel();
+			lastAutosave = now;
+		}
+	}
 
-	float involve_distance = galaxy->testDistancewithWormhole(camera);
+	// update time
+	simulationTime.advance(timeSpeed);
+	if (universe != NULL)
+	{
+		ProfileScope scope(profiler, "update universe");
+		// the trail of the spaceship moves along when the sector changes under it
+		int before[3], after[3];
+		universe->getSector(before);
+		universe->update(camera);
+		galaxy = universe->getCurrentSystem();
+		universe->getSector(after);
+		float shift[3];
+		for (int i = 0; i < 3; i++)
+		{
+			shift[i] = (before[i] - after[i]) * sectorSize;
+		}
+		shipTrail->shift(shift);
+	}
+
+	// both collision checks only need the new positions, so they run side by side
+	{
+		ProfileScope scope(profiler, "simulate");
+		JobGraph frame(jobs);
+		int moved = frame.add(moveBodies, NULL);
+		frame.add(checkPlanets, NULL, moved);
+		frame.add(checkWormholes, NULL, moved);
+		frame.run();
+	}
+	if (++trailFrame % trailInterval == 0)
+		sampleTrails();
+	bodyCount.set(galaxy->getBodyCount() + asteroidPositions.size() / 3);
+	float min_distance = planetDistance;
+	float involve_distance = wormholeDistance;
 
-	if (min_distance < 0.001f)
+	if (min_distance < contactDistance)
 		fellDown = true;
 
 	// draw a new scene to inform the user that the spaceship crashes
@@ -231,24 +954,99 @@ void display(void)
 		glTexCoord2f(0.0f, 1.0f);	glVertex2f(0.0f, 700.0f);
 		glEnd();
 
+		ProfileScope scope(profiler, "swap");
 		glFlush();
 		glutSwapBuffers();
 
 		return;
 	}
 
-	// generate a new galaxy when the spaceship is absorbed by the wormhole
-	if (involve_distance < 0.001f)
+	// in the open universe, start building the sectors on the other side as the spaceship gets close
+	if (universe != NULL && involve_distance < approachDistance)
 	{
-		srand((int)time);
-		int xixi = rand();
-		if (xixi % 6 == 0)
-			galaxy = new SolarSystem();
-		else
-			galaxy = new SolarSystem(0);
-		camera.reset();
+		if (!destinationChosen)
+		{
+			Random random(Random::combine(universeSeed, (uint64_t)simulationTime.days));
+			universe->getSector(targetSector);
+			for (int i = 0; i < 3; i++)
+			{
+				targetSector[i] += random.range(2 * wormholeReach + 1) - wormholeReach;
+			}
+			destinationChosen = true;
+		}
+		universe->prefetch(targetSector);
+	}
+	if (universe != NULL && involve_distance < contactDistance)
+		jumpPending = true;
+	if (universe != NULL && jumpPending)
+	{
+		universe->prefetch(targetSector);
+		if (universe->isBuilt(targetSector))
+		{
+			universe->moveTo(targetSector);
+			wormholeJumps.add();
+			galaxy = universe->getCurrentSystem();
+			destinationChosen = false;
+			jumpPending = false;
+			camera.reset();
+			shipTrail->clear(0, 1);
+		}
 	}
 
+	// start building the other side of the wormhole as the spaceship gets close,
+	// unless it's a system visited recently
+	if (universe == NULL && involve_distance < approachDistance)
+	{
+		if (!destinationChosen)
+		{
+			destinationId = builder->destination(currentSystemId, (uint64_t)simulationTime.days);
+			destinationChosen = true;
+		}
+		if (destinationId != currentSystemId && !cache->contains(destinationId))
+			builder->prepare(destinationId);
+		SolarSystem* next = builder->peek();
+		if (next != NULL && next != residentDestination)
+		{
+			next->makeResident();
+			residentDestination = next;
+		}
+	}
+
+	// move to the new galaxy when the spaceship is absorbed by the wormhole
+	if (universe == NULL && involve_distance < contactDistance)
+	{
+		if (!destinationChosen)
+			destinationId = builder->destination(currentSystemId, (uint64_t)simulationTime.days);
+		visitedSystems.push_back(currentSystemId);
+		if (visitedSystems.size() > maxVisitedSystems)
+			visitedSystems.erase(visitedSystems.begin());
+		jumpTo(destinationId);
+		wormholeJumps.add();
+	}
+
+	// the autopilot flies until the pilot takes over, the system changes or gravity takes the orbits away
+	if (autopilot->isEngaged() && (autopilot->getSystem() != galaxy || gravity != NULL || controls.forward || controls.backward))
+	{
+		autopilot->disengage();
+		autopilotStatus = "";
+	}
+	if (autopilot->isEngaged())
+	{
+		ProfileScope scope(profiler, "autopilot");
+		float position[3], direction[3];
+		camera.getPosition(position);
+		if (!autopilot->fly(position, simulationTime, timeSpeed, camera.getSpeed(), direction))
+		{
+			autopilotStatus = autopilot->hasArrived() ? "arrived" : "no safe way";
+		}
+		else if (lengthOfVec(direction) > 0.0f)
+		{
+			float aim[3] = {position[0] + direction[0], position[1] + direction[1], position[2] + direction[2]};
+			camera.pointAt(aim);
+			vectorMul(direction, camera.getSpeed());
+			camera.shift(direction);
+		}
+	}
 
 	if (controls.forward) camera.forward();		
 	if (controls.backward) camera.backward();
@@ -262,27 +1060,12 @@ void display(void)
 	glColor3f(1.0, 1.0, 1.0);
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
-	gluPerspective(70.0f, (float)screenWidth / (float)screenHeight, 0.001f, 500.0f);
+	gluPerspective(fieldOfView, (float)screenWidth / (float)screenHeight, nearPlane, farPlane);
 	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-	camera.transformOrientation();
-
-	// draw the skybox
-	glBindTexture(GL_TEXTURE_2D, stars->getTextureHandle());
-	drawCube();
-	camera.transformTranslation();
-
-	GLfloat lightPosition[] = {0.0, 0.0, 0.0, 1.0};
-	glLightfv(GL_LIGHT0, GL_POSITION, lightPosition);
-
-	// render the solar system
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_LIGHTING);
-	galaxy->render();
-	glDisable(GL_LIGHTING);
-	if (showOrbits)
-		galaxy->renderOrbits();
-	glDisable(GL_DEPTH_TEST);
+	{
+		ProfileScope scope(profiler, "scene");
+		renderScene();
+	}
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
 	gluOrtho2D(0.0, (GLdouble)screenWidth, (GLdouble)screenHeight, 0.0);
@@ -292,6 +1075,7 @@ void display(void)
 	// draw the spaceship
 	if (starshipView)
 	{
+		ProfileScope scope(profiler, "hud", true);
 		double x, y;
 		x = 6; y = 150;
 
@@ -415,12 +1199,39 @@ void display(void)
 		glEnd();
 	}
 
+	if (showOverlay)
+	{
+		ProfileScope scope(profiler, "overlay", true);
+		drawOverlay(min_distance);
+	}
+
+	ProfileScope scope(profiler, "swap");
 	glFlush();
 	glutSwapBuffers();
 }
 
-// registered function that handles issues when keys are pressed
-void keyDown(unsigned char key, int x, int y)
+// point the camera at the body in the middle of the view
+void focusInSight(void)
+{
+	float center[3];
+	if (universeMode)
+	{
+		if (!universe->pick(camera, center))
+			return;
+	}
+	else
+	{
+		float position[3], direction[3];
+		camera.getPosition(position);
+		camera.getViewDirection(direction);
+		if (galaxy->pick(position, direction, center) < 0)
+			return;
+	}
+	camera.pointAt(center);
+}
+
+// handle a key that was pressed, live or replayed
+void applyKeyDown(unsigned char key)
 {
 	if (key > '0' && key <= '9')
 	{
@@ -430,6 +1241,8 @@ void keyDown(unsigned char key, int x, int y)
 		galaxy->getPlanetPosition(key - '0', vec);
 		camera.pointAt(vec);
 		planetSelected = key - '0';
+		if (autopilot->isEngaged())
+			autopilot->engage(galaxy, planetSelected);
 	}
 
 	switch (key)
@@ -439,6 +1252,8 @@ void keyDown(unsigned char key, int x, int y)
 		break;
 	case '=':
 		timeSpeed *= 2.0f;
+		if (timeSpeed > maxTimeSpeed)
+			timeSpeed = maxTimeSpeed;
 		break;
 	case 'u':
 		starshipView = !starshipView;
@@ -446,6 +1261,16 @@ void keyDown(unsigned char key, int x, int y)
 	case 'o':
 		showOrbits = !showOrbits;
 		break;
+	case 'l':
+		showTrails = !showTrails;
+		break;
+	case 'h':
+		showOverlay = !showOverlay;
+		break;
+	case 'x':
+		if (profiler->writeTrace(tracePath))
+			printf("trace written to %s\n", tracePath);
+		break;
 	case ',':
 		camera.slowDown();
 		break;
@@ -469,22 +1294,55 @@ void keyDown(unsigned char key, int x, int y)
 	case 't':
 		fellDown = false;
 		camera.reset();
+		shipTrail->clear(0, 1);
+		if (gravity != NULL)
+			startGravity();
+		break;
+	case 'g':
+		if (gravity != NULL)
+			stopGravity();
+		else if (universe == NULL)
+			startGravity();
+		break;
+	case 'f':
+		focusInSight();
+		break;
+	case 'k':
+		autopilotStatus = "";
+		if (autopilot->isEngaged())
+			autopilot->disengage();
+		else if (gravity == NULL && galaxy->hasPlanet('0' + planetSelected) && !autopilot->engage(galaxy, planetSelected))
+			autopilotStatus = "too crowded";
 		break;
 	case 'p':
 		camera.saveImage();
 		break;
+	case 'P':
+		savePoster();
+		break;
 	case 'b':
 		saveModel();
 		break;
 	case 'n':
 		loadModel();
 		break;
+
+	// go back through the wormhole to the system visited before
+	case 'r':
+		if (universe == NULL && !visitedSystems.empty())
+		{
+			uint64_t previous = visitedSystems.back();
+			visitedSystems.pop_back();
+			jumpTo(previous);
+			wormholeJumps.add();
+		}
+		break;
 	}
 
 }
 
-// registered function that handles issues when keys are released
-void keyUp(unsigned char key, int x, int y)
+// handle a key that was released, live or replayed
+void applyKeyUp(unsigned char key)
 {
 	switch (key)
 	{
@@ -503,8 +1361,28 @@ void keyUp(unsigned char key, int x, int y)
 	}
 }
 
+// registered functions that handle issues when keys are pressed and released
+void keyDown(unsigned char key, int x, int y)
+{
+	if (replaying)
+		return;
+	recordInput(INPUT_KEY_DOWN, key, x, y);
+	applyKeyDown(key);
+}
+
+void keyUp(unsigned char key, int x, int y)
+{
+	if (replaying)
+		return;
+	recordInput(INPUT_KEY_UP, key, x, y);
+	applyKeyUp(key);
+}
+
 // set mouse-camera control connection
 void mouse(int x, int y){
+	if (replaying)
+		return;
+	recordInput(INPUT_MOUSE, 0, x, y);
 	camera.setMouse(x, y);
 }
 
@@ -516,9 +1394,171 @@ void reshape(int w, int h)
 	glViewport(0, 0, (GLsizei)w, (GLsizei)h);
 }
 
+// drive the frames of a headless run as fast as possible instead of on the timer
+void headlessFrame(void)
+{
+	display();
+	if (--headlessFrames > 0)
+		return;
+
+	if (posterRequested)
+		savePoster();
+
+	// frame times to compare runs of the same replay
+	updateFramePercentiles();
+	printf("frame time: median %.2f ms, 99th percentile %.2f ms\n", frameSecondsMedian.get() * 1000.0,
+		frameSecondsP99.get() * 1000.0);
+
+	// show how well the work was spread over the threads
+	std::vector<float> utilization;
+	jobs->getUtilization(utilization);
+	printf("thread utilization:");
+	for (int i = 0; i < utilization.size(); i++)
+	{
+		printf(" %.0f%%", utilization[i] * 100.0f);
+	}
+	printf("\n");
+	exit(0);
+}
+
+// drive the frames of the performance test, scene after scene
+void perfTestFrame(void)
+{
+	// every scene starts in the same place at the same time
+	if (perfFrame == 0)
+	{
+		const PerfScene& scene = PerfTest::getScene(perfScene);
+		if (gravity != NULL)
+			stopGravity();
+		simulationTime.set(2.552);
+		timeSpeed = 0.1f;
+		asteroidCount = scene.asteroids;
+		jumpTo(scene.systemId);
+		if (scene.asteroids > 0)
+			startGravity();
+		perfTest->beginScene(perfScene);
+	}
+
+	bool measured = perfFrame >= perfWarmupFrames;
+	if (measured)
+		perfTest->beginFrame();
+	display();
+	if (measured)
+		perfTest->endFrame();
+	if (++perfFrame < perfWarmupFrames + perfMeasuredFrames)
+		return;
+
+	perfPassed = perfTest->report() && perfPassed;
+	perfFrame = 0;
+	if (++perfScene < PerfTest::getSceneCount())
+		return;
+	printf(perfPassed ? "all scenes are within their budgets\n" : "some scenes are over their budgets\n");
+	exit(perfPassed ? 0 : 1);
+}
+
+// parse the command line, options are
+//   -headless <frames>          render the frames without showing the window, then quit
+//   -poster <width> <height>    size of the poster saved with 'P' or at the end of a headless run
+//   -cache <megabytes>          memory budget for recently visited systems
+//   -catalog <path>             use a compiled catalog instead of compiling data/systems.txt
+//   -universe <seed>            fly through an open universe of sectors made from the seed
+//   -threads <count>            threads the work of a frame is spread over, all cores by default
+//   -gravity <asteroids>        start in gravity mode with a belt of that many asteroids
+//   -theta <value>              accuracy of gravity, smaller is more accurate and slower
+//   -trace <path>               write the trace of the latest frames there with 'x' and at the exit
+//   -perftest                   render the canned scenes headlessly and check them against their budgets
+//   -record <path>              record the input into a log written at the exit
+//   -replay <path>              replay the input of a log, a headless run of 0 frames takes as many as the log
+//   -stats <path>               write the metrics there every few seconds
+void parseArguments(int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-headless") == 0 && i + 1 < argc)
+		{
+			headless = true;
+			headlessFrames = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-poster") == 0 && i + 2 < argc)
+		{
+			posterRequested = true;
+			posterWidth = atoi(argv[++i]);
+			posterHeight = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-cache") == 0 && i + 1 < argc)
+		{
+			cacheBudget = (size_t)atoi(argv[++i]) * 1024 * 1024;
+		}
+		else if (strcmp(argv[i], "-universe") == 0 && i + 1 < argc)
+		{
+			universeMode = true;
+			universeSeed = strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "-gravity") == 0 && i + 1 < argc)
+		{
+			gravityMode = true;
+			asteroidCount = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-theta") == 0 && i + 1 < argc)
+		{
+			gravityTheta = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-trace") == 0 && i + 1 < argc)
+		{
+			tracePath = argv[++i];
+			traceAtExit = true;
+		}
+		else if (strcmp(argv[i], "-stats") == 0 && i + 1 < argc)
+		{
+			statsPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "-perftest") == 0)
+		{
+			perfTestMode = true;
+			headless = true;
+		}
+		else if (strcmp(argv[i], "-record") == 0 && i + 1 < argc)
+		{
+			recordPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "-replay") == 0 && i + 1 < argc)
+		{
+			replayPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+		{
+			jobThreads = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-catalog") == 0 && i + 1 < argc)
+		{
+			catalogPath = argv[++i];
+			catalogSource = NULL;
+		}
+	}
+}
+
 int main(int argc, char** argv)
 {
 	glutInit(&argc, argv);
+	parseArguments(argc, argv);
+
+	// the log decides what the run flies through
+	if (replayPath != NULL)
+	{
+		if (!readInputLog(replayPath, &inputLog))
+		{
+			fprintf(stderr, "%s is not a valid input log\n", replayPath);
+			return 1;
+		}
+		replaying = true;
+		universeMode = inputLog.start.universeMode != 0;
+		universeSeed = inputLog.start.universeSeed;
+		gravityMode = inputLog.start.gravityMode != 0;
+		asteroidCount = inputLog.start.asteroidCount;
+		gravityTheta = inputLog.start.gravityTheta;
+		if (headless && headlessFrames <= 0)
+			headlessFrames = inputLog.frameCount;
+	}
 	glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
 	glutInitWindowSize(1920, 1080);
 	glutInitWindowPosition(0, 0);
@@ -526,9 +1566,29 @@ int main(int argc, char** argv)
 	init();
 	glutDisplayFunc(display);
 	glutReshapeFunc(reshape);
-	glutKeyboardFunc(keyDown);
-	glutKeyboardUpFunc(keyUp);
-	glutPassiveMotionFunc(mouse);
+	if (headless)
+	{
+		glutHideWindow();
+		screenWidth = 1920;
+		screenHeight = 1080;
+		glViewport(0, 0, screenWidth, screenHeight);
+		if (perfTestMode)
+		{
+			perfTest = new PerfTest(profiler);
+			glutIdleFunc(perfTestFrame);
+		}
+		else
+		{
+			glutIdleFunc(headlessFrame);
+		}
+	}
+	else
+	{
+		glutKeyboardFunc(keyDown);
+		glutKeyboardUpFunc(keyUp);
+		glutPassiveMotionFunc(mouse);
+		timer(0);
+	}
 	glutMainLoop();
 	return 0;
 }
\ No newline at end of file
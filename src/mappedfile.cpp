@@ -0,0 +1,104 @@
+#include "mappedfile.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MappedFile::MappedFile(void)
+{
+	data = NULL;
+	size = 0;
+#ifdef _WIN32
+	file = INVALID_HANDLE_VALUE;
+	mapping = NULL;
+#else
+	file = -1;
+#endif
+}
+
+MappedFile::~MappedFile(void)
+{
+	close();
+}
+
+bool MappedFile::open(const char* path)
+{
+	close();
+#ifdef _WIN32
+	file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+	size = (size_t)fileSize.QuadPart;
+
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		close();
+		return false;
+	}
+	data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+	file = ::open(path, O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat status;
+	if (fstat(file, &status) != 0 || status.st_size == 0)
+	{
+		close();
+		return false;
+	}
+	size = (size_t)status.st_size;
+
+	void* view = mmap(NULL, size, PROT_READ, MAP_SHARED, file, 0);
+	data = view == MAP_FAILED ? NULL : (const unsigned char*)view;
+#endif
+	if (data == NULL)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close(void)
+{
+#ifdef _WIN32
+	if (data != NULL)
+		UnmapViewOfFile(data);
+	if (mapping != NULL)
+		CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+	mapping = NULL;
+	file = INVALID_HANDLE_VALUE;
+#else
+	if (data != NULL)
+		munmap((void*)data, size);
+	if (file >= 0)
+		::close(file);
+	file = -1;
+#endif
+	data = NULL;
+	size = 0;
+}
+
+const unsigned char* MappedFile::getData(void)
+{
+	return data;
+}
+
+size_t MappedFile::getSize(void)
+{
+	return size;
+}
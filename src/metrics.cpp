@@ -0,0 +1,214 @@
+#include "metrics.h"
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+// frame times of 240, 144, 120, 60, 30, 20, 15, 10, 4, 2 and 1 frames per second
+static const double frameBounds[] = {1.0 / 240, 1.0 / 144, 1.0 / 120, 1.0 / 60, 1.0 / 30, 1.0 / 20, 1.0 / 15, 0.1, 0.25, 0.5, 1.0};
+
+Counter framesRendered;
+Histogram frameSeconds(frameBounds, sizeof(frameBounds) / sizeof(frameBounds[0]));
+Gauge frameSecondsMedian;
+Gauge frameSecondsP99;
+Counter drawCalls;
+Counter textureBinds;
+Counter verticesSubmitted;
+Counter bytesUploaded;
+Gauge textureMemory;
+Gauge bodyCount;
+Counter wormholeJumps;
+
+enum MetricType
+{
+	METRIC_COUNTER,
+	METRIC_GAUGE,
+	METRIC_HISTOGRAM
+};
+
+struct MetricEntry
+{
+	const char* name;
+	const char* help;
+	MetricType type;
+	void* metric;
+};
+
+static const MetricEntry entries[] =
+{
+	{"swm_frames_total", "Frames rendered.", METRIC_COUNTER, &framesRendered},
+	{"swm_frame_seconds", "Time from one frame to the next.", METRIC_HISTOGRAM, &frameSeconds},
+	{"swm_frame_seconds_p50", "Median time of the latest frames.", METRIC_GAUGE, &frameSecondsMedian},
+	{"swm_frame_seconds_p99", "99th percentile of the time of the latest frames.", METRIC_GAUGE, &frameSecondsP99},
+	{"swm_draw_calls_total", "Draw calls issued.", METRIC_COUNTER, &drawCalls},
+	{"swm_texture_binds_total", "Textures bound for drawing.", METRIC_COUNTER, &textureBinds},
+	{"swm_vertices_total", "Vertices submitted.", METRIC_COUNTER, &verticesSubmitted},
+	{"swm_uploaded_bytes_total", "Bytes of textures and vertices sent to the card.", METRIC_COUNTER, &bytesUploaded},
+	{"swm_texture_memory_bytes", "Bytes of all textures with their mipmaps.", METRIC_GAUGE, &textureMemory},
+	{"swm_bodies", "Bodies of the current system, asteroids included.", METRIC_GAUGE, &bodyCount},
+	{"swm_wormhole_jumps_total", "Jumps through wormholes.", METRIC_COUNTER, &wormholeJumps}
+};
+
+Counter::Counter(void)
+{
+	value = 0;
+}
+
+void Counter::add(int64_t amount)
+{
+	value.fetch_add(amount, std::memory_order_relaxed);
+}
+
+int64_t Counter::get(void)
+{
+	return value.load(std::memory_order_relaxed);
+}
+
+Gauge::Gauge(void)
+{
+	value = 0.0;
+}
+
+void Gauge::set(double value)
+{
+	this->value.store(value, std::memory_order_relaxed);
+}
+
+void Gauge::add(double amount)
+{
+	double current = value.load(std::memory_order_relaxed);
+	while (!value.compare_exchange_weak(current, current + amount, std::memory_order_relaxed))
+		;
+}
+
+double Gauge::get(void)
+{
+	return value.load(std::memory_order_relaxed);
+}
+
+Histogram::Histogram(const double* bounds, int bucketCount)
+{
+	if (bucketCount > maxBuckets)
+		bucketCount = maxBuckets;
+	this->bucketCount = bucketCount;
+	for (int i = 0; i < bucketCount; i++)
+	{
+		this->bounds[i] = bounds[i];
+	}
+	for (int i = 0; i <= bucketCount; i++)
+	{
+		counts[i] = 0;
+	}
+	count = 0;
+}
+
+void Histogram::observe(double value)
+{
+	int bucket = 0;
+	while (bucket < bucketCount && value > bounds[bucket])
+		bucket++;
+	counts[bucket].fetch_add(1, std::memory_order_relaxed);
+	count.fetch_add(1, std::memory_order_relaxed);
+	sum.add(value);
+}
+
+int Histogram::getBucketCount(void)
+{
+	return bucketCount;
+}
+
+double Histogram::getBound(int bucket)
+{
+	return bounds[bucket];
+}
+
+int64_t Histogram::getCumulativeCount(int bucket)
+{
+	int64_t total = 0;
+	for (int i = 0; i <= bucket && i <= bucketCount; i++)
+	{
+		total += counts[i].load(std::memory_order_relaxed);
+	}
+	return total;
+}
+
+int64_t Histogram::getCount(void)
+{
+	return count.load(std::memory_order_relaxed);
+}
+
+double Histogram::getSum(void)
+{
+	return sum.get();
+}
+
+static void appendLine(std::string& text, const char* format, const char* name, double value)
+{
+	char line[256];
+	snprintf(line, sizeof(line), format, name, value);
+	text += line;
+}
+
+void formatMetrics(std::string& text)
+{
+	text.clear();
+	for (int i = 0; i < sizeof(entries) / sizeof(entries[0]); i++)
+	{
+		const MetricEntry& entry = entries[i];
+		static const char* typeNames[] = {"counter", "gauge", "histogram"};
+		text += std::string("# HELP ") + entry.name + " " + entry.help + "\n";
+		text += std::string("# TYPE ") + entry.name + " " + typeNames[entry.type] + "\n";
+		if (entry.type == METRIC_COUNTER)
+		{
+			appendLine(text, "%s %.0f\n", entry.name, (double)((Counter*)entry.metric)->get());
+		}
+		else if (entry.type == METRIC_GAUGE)
+		{
+			appendLine(text, "%s %.9g\n", entry.name, ((Gauge*)entry.metric)->get());
+		}
+		else
+		{
+			// the buckets count every value up to their bound, the last one counts all of them
+			Histogram* histogram = (Histogram*)entry.metric;
+			char line[256];
+			for (int j = 0; j < histogram->getBucketCount(); j++)
+			{
+				snprintf(line, sizeof(line), "%s_bucket{le=\"%.6g\"} %.0f\n", entry.name,
+					histogram->getBound(j), (double)histogram->getCumulativeCount(j));
+				text += line;
+			}
+			snprintf(line, sizeof(line), "%s_bucket{le=\"+Inf\"} %.0f\n", entry.name,
+				(double)histogram->getCumulativeCount(histogram->getBucketCount()));
+			text += line;
+			snprintf(line, sizeof(line), "%s_sum %.9g\n%s_count %.0f\n", entry.name, histogram->getSum(),
+				entry.name, (double)histogram->getCount());
+			text += line;
+		}
+	}
+}
+
+bool writeMetrics(const char* path)
+{
+	std::string text;
+	formatMetrics(text);
+
+	// write next to the file and then replace it
+	std::string temporary = std::string(path) + ".tmp";
+	FILE* file = fopen(temporary.c_str(), "w");
+	if (file == NULL)
+		return false;
+	bool written = fwrite(text.data(), 1, text.size(), file) == text.size();
+	written = fclose(file) == 0 && written;
+	if (!written)
+	{
+		remove(temporary.c_str());
+		return false;
+	}
+#ifdef _WIN32
+	return MoveFileExA(temporary.c_str(), path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return rename(temporary.c_str(), path) == 0;
+#endif
+}
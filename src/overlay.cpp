@@ -0,0 +1,233 @@
+#include "overlay.h"
+#include <cstdio>
+#include <cstdarg>
+#include <cctype>
+#include <cstddef>
+#include "metrics.h"
+#include "glcount.h"
+
+// the letters from space to underscore, 5 by 7 pixels with the leftmost one in bit 4 of each row
+static const int firstGlyph = 32;
+static const int glyphCount = 64;
+static const unsigned char glyphs[glyphCount][7] =
+{
+	{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},	// space
+	{0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04},	// !
+	{0x0a, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00},	// "
+	{0x0a, 0x0a, 0x1f, 0x0a, 0x1f, 0x0a, 0x0a},	// #
+	{0x04, 0x0f, 0x14, 0x0e, 0x05, 0x1e, 0x04},	// $
+	{0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03},	// %
+	{0x0c, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0d},	// &
+	{0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00},	// '
+	{0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02},	// (
+	{0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08},	// )
+	{0x00, 0x04, 0x15, 0x0e, 0x15, 0x04, 0x00},	// *
+	{0x00, 0x04, 0x04, 0x1f, 0x04, 0x04, 0x00},	// +
+	{0x00, 0x00, 0x00, 0x00, 0x0c, 0x04, 0x08},	// ,
+	{0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00},	// -
+	{0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c},	// .
+	{0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00},	// /
+	{0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e},	// 0
+	{0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e},	// 1
+	{0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f},	// 2
+	{0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e},	// 3
+	{0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02},	// 4
+	{0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e},	// 5
+	{0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e},	// 6
+	{0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08},	// 7
+	{0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e},	// 8
+	{0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c},	// 9
+	{0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00},	// :
+	{0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x04, 0x08},	// ;
+	{0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02},	// <
+	{0x00, 0x00, 0x1f, 0x00, 0x1f, 0x00, 0x00},	// =
+	{0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08},	// >
+	{0x0e, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04},	// ?
+	{0x0e, 0x11, 0x01, 0x0d, 0x15, 0x15, 0x0e},	// @
+	{0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11},	// A
+	{0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e},	// B
+	{0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e},	// C
+	{0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c},	// D
+	{0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f},	// E
+	{0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10},	// F
+	{0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f},	// G
+	{0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11},	// H
+	{0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e},	// I
+	{0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c},	// J
+	{0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11},	// K
+	{0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f},	// L
+	{0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11},	// M
+	{0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11},	// N
+	{0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e},	// O
+	{0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10},	// P
+	{0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d},	// Q
+	{0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11},	// R
+	{0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e},	// S
+	{0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},	// T
+	{0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e},	// U
+	{0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04},	// V
+	{0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a},	// W
+	{0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11},	// X
+	{0x11, 0x11, 0x0a, 0x04, 0x04, 0x04, 0x04},	// Y
+	{0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f},	// Z
+	{0x0e, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0e},	// [
+	{0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00},	// backslash
+	{0x0e, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0e},	// ]
+	{0x04, 0x0a, 0x11, 0x00, 0x00, 0x00, 0x00},	// ^
+	{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f},	// _
+};
+
+// the texture holds 16 letters in a row, each in a cell of 8 by 8 texels, and a solid cell below them
+static const int atlasWidth = 128;
+static const int atlasHeight = 64;
+static const int cellSize = 8;
+static const int solidRow = 4;
+
+Overlay::Overlay(float scale)
+{
+	this->scale = scale;
+	atlas = 0;
+	buffer = 0;
+	created = false;
+}
+
+Overlay::~Overlay(void)
+{
+	if (atlas != 0)
+		glDeleteTextures(1, &atlas);
+	if (buffer != 0)
+		glExtensions.deleteBuffers(1, &buffer);
+}
+
+void Overlay::createObjects(void)
+{
+	unsigned char texels[atlasHeight][atlasWidth] = {{0}};
+	for (int i = 0; i < glyphCount; i++)
+	{
+		int left = (i % 16) * cellSize, top = (i / 16) * cellSize;
+		for (int row = 0; row < 7; row++)
+		{
+			for (int column = 0; column < 5; column++)
+			{
+				if (glyphs[i][row] & (0x10 >> column))
+					texels[top + row][left + column] = 255;
+			}
+		}
+	}
+	for (int row = 0; row < cellSize; row++)
+	{
+		for (int column = 0; column < cellSize; column++)
+		{
+			texels[solidRow * cellSize + row][column] = 255;
+		}
+	}
+
+	glGenTextures(1, &atlas);
+	glBindTexture(GL_TEXTURE_2D, atlas);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, atlasWidth, atlasHeight, 0, GL_ALPHA, GL_UNSIGNED_BYTE, texels);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	if (glExtensions.buffers)
+		glExtensions.genBuffers(1, &buffer);
+	created = true;
+}
+
+void Overlay::clear(void)
+{
+	vertices.clear();
+}
+
+void Overlay::quad(float left, float top, float right, float bottom, float s0, float t0, float s1, float t1, const unsigned char* color)
+{
+	Vertex corners[4] =
+	{
+		{{left, top}, {s0, t0}, {color[0], color[1], color[2], color[3]}},
+		{{right, top}, {s1, t0}, {color[0], color[1], color[2], color[3]}},
+		{{right, bottom}, {s1, t1}, {color[0], color[1], color[2], color[3]}},
+		{{left, bottom}, {s0, t1}, {color[0], color[1], color[2], color[3]}}
+	};
+	vertices.insert(vertices.end(), corners, corners + 4);
+}
+
+void Overlay::print(float x, float y, const unsigned char* color, const char* format, ...)
+{
+	char line[256];
+	va_list arguments;
+	va_start(arguments, format);
+	vsnprintf(line, sizeof(line), format, arguments);
+	va_end(arguments);
+
+	for (const char* c = line; *c != 0; c++, x += letterWidth * scale)
+	{
+		int glyph = toupper((unsigned char)*c) - firstGlyph;
+		if (glyph <= 0 || glyph >= glyphCount)
+			continue;
+		float s = (float)((glyph % 16) * cellSize) / atlasWidth;
+		float t = (float)((glyph / 16) * cellSize) / atlasHeight;
+		quad(x, y, x + 5 * scale, y + 7 * scale, s, t, s + 5.0f / atlasWidth, t + 7.0f / atlasHeight, color);
+	}
+}
+
+void Overlay::rect(float x, float y, float width, float height, const unsigned char* color)
+{
+	// the middle of the solid cell, so filtering never reaches a letter
+	float s = (cellSize / 2.0f) / atlasWidth;
+	float t = (solidRow * cellSize + cellSize / 2.0f) / atlasHeight;
+	quad(x, y, x + width, y + height, s, t, s, t, color);
+}
+
+void Overlay::graph(float x, float y, float width, float height, const float* values, int count, float maxValue,
+	float warning, const unsigned char* color, const unsigned char* warningColor)
+{
+	float barWidth = width / count;
+	for (int i = 0; i < count; i++)
+	{
+		float barHeight = values[i] < maxValue ? height * values[i] / maxValue : height;
+		rect(x + i * barWidth, y + height - barHeight, barWidth, barHeight, values[i] < warning ? color : warningColor);
+	}
+}
+
+void Overlay::render(void)
+{
+	if (!created)
+		createObjects();
+	if (vertices.empty())
+		return;
+
+	glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT | GL_TEXTURE_BIT);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, atlas);
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// the whole frame goes up in one piece, replacing what the card had
+	const char* base = (const char*)&vertices[0];
+	if (buffer != 0)
+	{
+		glExtensions.bindBuffer(GL_ARRAY_BUFFER, buffer);
+		glExtensions.bufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(vertices.size() * sizeof(Vertex)), base, GL_STREAM_DRAW);
+		base = NULL;
+	}
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, position));
+	glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, coordinates));
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), base + offsetof(Vertex, color));
+	glDrawArrays(GL_QUADS, 0, (GLsizei)vertices.size());
+	verticesSubmitted.add(vertices.size());
+	if (buffer != 0)
+		bytesUploaded.add(vertices.size() * sizeof(Vertex));
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	if (buffer != 0)
+		glExtensions.bindBuffer(GL_ARRAY_BUFFER, 0);
+	glPopAttrib();
+}
@@ -0,0 +1,172 @@
+#include "perftest.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <atomic>
+#include <algorithm>
+#include "glcount.h"
+
+// with SWM_COUNT_ALLOCATIONS every allocation of the program is counted, a relaxed increment is all it costs,
+// other builds keep the allocator of the library and check no allocation budget
+#ifdef SWM_COUNT_ALLOCATIONS
+static std::atomic<int64_t> allocationCount(0);
+
+void* operator new(size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	void* memory = malloc(size > 0 ? size : 1);
+	if (memory == NULL)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	free(memory);
+}
+
+int64_t getAllocationCount(void)
+{
+	return allocationCount.load(std::memory_order_relaxed);
+}
+#else
+int64_t getAllocationCount(void)
+{
+	return -1;
+}
+#endif
+
+// The scenes and their budgets, for drivers with glMultiDrawArrays.
+// Counts follow from what the scenes hold: a body is a sphere of 30 stacks, and the cockpit takes a dozen draws.
+// Times are loose enough for the kiosks, a change that doubles the work of a phase still breaks them.
+static const PerfScene scenes[] =
+{
+	{"sol", 0, 0, 600, 48, 160, 32, {{"frame", 16.0f}, {"simulate", 2.0f}, {"scene", 8.0f}, {"hud", 2.0f}}},
+	{"generated 1001", 1001, 0, 700, 48, 160, 32, {{"frame", 16.0f}, {"simulate", 2.0f}, {"scene", 8.0f}, {"hud", 2.0f}}},
+	{"generated 424242", 424242, 0, 700, 48, 160, 32, {{"frame", 16.0f}, {"simulate", 2.0f}, {"scene", 8.0f}, {"hud", 2.0f}}},
+	{"stress 9001", 9001, 4000, 700, 48, 160, 64, {{"frame", 33.0f}, {"simulate", 12.0f}, {"scene", 12.0f}, {"sample trails", 1.0f}}}
+};
+
+PerfTest::PerfTest(Profiler* profiler)
+{
+	this->profiler = profiler;
+	scene = 0;
+	startDrawCalls = startTextureBinds = startStateChanges = startAllocations = 0;
+	startEvent = 0;
+}
+
+int PerfTest::getSceneCount(void)
+{
+	return sizeof(scenes) / sizeof(scenes[0]);
+}
+
+const PerfScene& PerfTest::getScene(int index)
+{
+	return scenes[index];
+}
+
+void PerfTest::beginScene(int index)
+{
+	scene = index;
+	drawCalls.clear();
+	textureBinds.clear();
+	stateChanges.clear();
+	allocations.clear();
+	for (int i = 0; i < maxPhaseBudgets; i++)
+	{
+		phaseTimes[i].clear();
+	}
+}
+
+void PerfTest::beginFrame(void)
+{
+	startDrawCalls = glCalls.drawCalls;
+	startTextureBinds = glCalls.textureBinds;
+	startStateChanges = glCalls.stateChanges;
+	startEvent = profiler->getEventCount();
+	startAllocations = getAllocationCount();
+}
+
+void PerfTest::endFrame(void)
+{
+	// the allocations of the test itself don't count
+	int64_t allocated = getAllocationCount() - startAllocations;
+	drawCalls.push_back(glCalls.drawCalls - startDrawCalls);
+	textureBinds.push_back(glCalls.textureBinds - startTextureBinds);
+	stateChanges.push_back(glCalls.stateChanges - startStateChanges);
+	allocations.push_back(allocated);
+
+	// a phase may run more than once in a frame, its times add up
+	const PerfScene& budget = scenes[scene];
+	float times[maxPhaseBudgets] = {0.0f};
+	uint64_t end = profiler->getEventCount();
+	for (uint64_t i = startEvent; i < end; i++)
+	{
+		const char* name;
+		int64_t duration;
+		bool gpu;
+		if (!profiler->getEvent(i, &name, &duration, &gpu) || gpu)
+			continue;
+		for (int j = 0; j < maxPhaseBudgets; j++)
+		{
+			if (budget.phases[j].phase != NULL && strcmp(budget.phases[j].phase, name) == 0)
+				times[j] += duration * 1e-6f;
+		}
+	}
+	for (int i = 0; i < maxPhaseBudgets; i++)
+	{
+		phaseTimes[i].push_back(times[i]);
+	}
+}
+
+bool PerfTest::compare(const char* what, double value, double budget, const char* format)
+{
+	char measured[32], allowed[32];
+	snprintf(measured, sizeof(measured), format, value);
+	snprintf(allowed, sizeof(allowed), format, budget);
+	bool within = value <= budget;
+	if (within)
+		printf("       %-22s %10s of %10s\n", what, measured, allowed);
+	else
+		printf("  OVER %-22s %10s of %10s  +%.0f%%\n", what, measured, allowed, (value / budget - 1.0) * 100.0);
+	return within;
+}
+
+bool PerfTest::report(void)
+{
+	const PerfScene& budget = scenes[scene];
+	printf("%s, %d frames\n", budget.name, (int)drawCalls.size());
+	if (drawCalls.empty())
+		return true;
+
+	bool passed = true;
+	passed = compare("draw calls", (double)*std::max_element(drawCalls.begin(), drawCalls.end()), (double)budget.drawCalls, "%.0f") && passed;
+	passed = compare("texture binds", (double)*std::max_element(textureBinds.begin(), textureBinds.end()), (double)budget.textureBinds, "%.0f") && passed;
+	passed = compare("state changes", (double)*std::max_element(stateChanges.begin(), stateChanges.end()), (double)budget.stateChanges, "%.0f") && passed;
+	if (getAllocationCount() >= 0)
+		passed = compare("allocations", (double)*std::max_element(allocations.begin(), allocations.end()), (double)budget.allocations, "%.0f") && passed;
+	else
+		printf("       %-22s not counted without SWM_COUNT_ALLOCATIONS\n", "allocations");
+	for (int i = 0; i < maxPhaseBudgets; i++)
+	{
+		if (budget.phases[i].phase == NULL)
+			continue;
+		std::vector<float> sorted(phaseTimes[i]);
+		std::sort(sorted.begin(), sorted.end());
+		char what[64];
+		snprintf(what, sizeof(what), "%s ms", budget.phases[i].phase);
+		passed = compare(what, sorted[sorted.size() / 2], budget.phases[i].milliseconds, "%.2f") && passed;
+	}
+	return passed;
+}
@@ -0,0 +1,251 @@
+#include "profiler.h"
+#include <cstdio>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+// the track of the calling thread, 0 until it records its first event
+static thread_local int threadTrack = 0;
+static std::atomic<int> nextTrack(1);
+
+static bool earlier(const std::pair<int64_t, int>& a, const std::pair<int64_t, int>& b)
+{
+	return a.first < b.first;
+}
+
+Profiler::Profiler(int capacity)
+{
+	this->capacity = 1;
+	while (this->capacity < (uint64_t)capacity)
+		this->capacity *= 2;
+	slots = new Slot[this->capacity];
+	for (uint64_t i = 0; i < this->capacity; i++)
+	{
+		slots[i].sequence = 0;
+	}
+	next = 0;
+	for (int i = 0; i < maxTracks; i++)
+	{
+		trackNames[i] = NULL;
+	}
+	trackNames[gpuTrack] = "GPU";
+
+	gpuReady = false;
+	gpuFrame = 0;
+	gpuOffset = 0;
+	for (int i = 0; i < gpuFrameCount; i++)
+	{
+		gpuFrames[i].count = 0;
+	}
+}
+
+Profiler::~Profiler(void)
+{
+	if (gpuReady)
+	{
+		for (int i = 0; i < gpuFrameCount; i++)
+		{
+			for (int j = 0; j < maxGpuScopes; j++)
+			{
+				glExtensions.deleteQueries(2, gpuFrames[i].scopes[j].queries);
+			}
+		}
+	}
+	delete[] slots;
+}
+
+int64_t Profiler::now(void)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int Profiler::currentTrack(void)
+{
+	if (threadTrack == 0)
+		threadTrack = nextTrack++;
+	return threadTrack;
+}
+
+void Profiler::push(const char* name, int64_t start, int64_t duration, int track)
+{
+	uint64_t index = next++;
+	Slot& slot = slots[index & (capacity - 1)];
+
+	// readers skip the slot until the whole event is there
+	slot.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.event.name = name;
+	slot.event.start = start;
+	slot.event.duration = duration;
+	slot.event.track = track;
+	slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::record(const char* name, int64_t start, int64_t duration)
+{
+	push(name, start, duration, currentTrack());
+}
+
+void Profiler::nameThread(const char* name)
+{
+	int track = currentTrack();
+	if (track < maxTracks)
+		trackNames[track] = name;
+}
+
+void Profiler::beginFrame(void)
+{
+	GLExtensions& gl = glExtensions;
+	if (!gl.timerQueries)
+		return;
+	if (!gpuReady)
+	{
+		for (int i = 0; i < gpuFrameCount; i++)
+		{
+			for (int j = 0; j < maxGpuScopes; j++)
+			{
+				gl.genQueries(2, gpuFrames[i].scopes[j].queries);
+			}
+		}
+		gpuReady = true;
+	}
+
+	// the frame about to be reused was issued a few frames ago, its queries are usually done by now
+	gpuFrame = (gpuFrame + 1) % gpuFrameCount;
+	GLint64 gpuNow = 0;
+	gl.getInteger64v(GL_TIMESTAMP, &gpuNow);
+	gpuOffset = now() - gpuNow;
+	collectGpu(gpuFrames[gpuFrame]);
+}
+
+void Profiler::collectGpu(GpuFrame& frame)
+{
+	GLExtensions& gl = glExtensions;
+	for (int i = 0; i < frame.count; i++)
+	{
+		// a scope the card hasn't finished yet is dropped rather than waited for
+		GpuScope& scope = frame.scopes[i];
+		GLint available = 0;
+		gl.getQueryObjectiv(scope.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			continue;
+
+		GLuint64 begin = 0, end = 0;
+		gl.getQueryObjectui64v(scope.queries[0], GL_QUERY_RESULT, &begin);
+		gl.getQueryObjectui64v(scope.queries[1], GL_QUERY_RESULT, &end);
+		push(scope.name, (int64_t)begin + gpuOffset, (int64_t)(end - begin), gpuTrack);
+	}
+	frame.count = 0;
+}
+
+int Profiler::beginGpu(const char* name)
+{
+	GpuFrame& frame = gpuFrames[gpuFrame];
+	if (!gpuReady || frame.count == maxGpuScopes)
+		return -1;
+	GpuScope& scope = frame.scopes[frame.count];
+	scope.name = name;
+	glExtensions.queryCounter(scope.queries[0], GL_TIMESTAMP);
+	return frame.count++;
+}
+
+void Profiler::endGpu(int scope)
+{
+	if (scope < 0)
+		return;
+	glExtensions.queryCounter(gpuFrames[gpuFrame].scopes[scope].queries[1], GL_TIMESTAMP);
+}
+
+uint64_t Profiler::getEventCount(void)
+{
+	return next;
+}
+
+bool Profiler::getEvent(uint64_t index, const char** name, int64_t* duration, bool* gpu)
+{
+	Slot& slot = slots[index & (capacity - 1)];
+	uint64_t before = slot.sequence.load(std::memory_order_acquire);
+	Event event = slot.event;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (before != index + 1 || slot.sequence.load(std::memory_order_relaxed) != before)
+		return false;
+	*name = event.name;
+	*duration = event.duration;
+	*gpu = event.track == gpuTrack;
+	return true;
+}
+
+bool Profiler::writeTrace(const char* path)
+{
+	// take the events that are complete, while other threads may go on recording
+	std::vector<Event> events;
+	events.reserve((size_t)capacity);
+	for (uint64_t i = 0; i < capacity; i++)
+	{
+		Slot& slot = slots[i];
+		uint64_t before = slot.sequence.load(std::memory_order_acquire);
+		Event event = slot.event;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+		if (before != 0 && before == after)
+			events.push_back(event);
+	}
+
+	// the events are written in the order they started, timed from the first of them
+	std::vector<std::pair<int64_t, int> > order(events.size());
+	for (int i = 0; i < events.size(); i++)
+	{
+		order[i] = std::make_pair(events[i].start, i);
+	}
+	std::sort(order.begin(), order.end(), earlier);
+	int64_t origin = order.empty() ? 0 : order[0].first;
+
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+		return false;
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	int tracks = nextTrack;
+	if (tracks > maxTracks)
+		tracks = maxTracks;
+	for (int i = 0; i < tracks; i++)
+	{
+		const char* name = trackNames[i];
+		if (name != NULL)
+			fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n", i, name);
+		else
+			fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}},\n", i, i);
+		fprintf(file, "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}%s\n",
+			i, i, i + 1 < tracks || !order.empty() ? "," : "");
+	}
+	for (int i = 0; i < order.size(); i++)
+	{
+		const Event& event = events[order[i].second];
+		fprintf(file, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+			event.name, event.track == gpuTrack ? "gpu" : "cpu", event.track,
+			(event.start - origin) / 1000.0, event.duration / 1000.0, i + 1 < order.size() ? "," : "");
+	}
+	fprintf(file, "]}\n");
+	bool written = ferror(file) == 0;
+	fclose(file);
+	return written;
+}
+
+ProfileScope::ProfileScope(Profiler* profiler, const char* name, bool gpu)
+{
+	this->profiler = profiler;
+	this->name = name;
+	gpuScope = -1;
+	if (profiler == NULL)
+		return;
+	if (gpu)
+		gpuScope = profiler->beginGpu(name);
+	start = Profiler::now();
+}
+
+ProfileScope::~ProfileScope(void)
+{
+	if (profiler == NULL)
+		return;
+	profiler->record(name, start, Profiler::now() - start);
+	profiler->endGpu(gpuScope);
+}
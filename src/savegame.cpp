@@ -0,0 +1,284 @@
+#include "savegame.h"
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include "mappedfile.h"
+#include "tga.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// The following structures are the layout of a save on the disk, all little-endian.
+struct SaveHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t headerSize;
+	uint32_t sectionCount;
+	uint64_t fileSize;
+
+	// FNV-1a hash of everything after the header
+	uint32_t checksum;
+	uint32_t sequence;
+};
+
+struct SaveSection
+{
+	uint32_t id;
+	uint32_t count;
+	uint64_t offset;
+	uint64_t length;
+};
+
+enum SaveSectionId
+{
+	SECTION_STATE = 1,
+	SECTION_CAMERA = 2,
+	SECTION_BODIES = 3,
+	SECTION_ASSETS = 4,
+	SECTION_COUNT = 4
+};
+
+static const char saveMagic[4] = {'S', 'W', 'M', 'S'};
+
+// size of a single record of the section
+static size_t recordSize(uint32_t id)
+{
+	switch (id)
+	{
+	case SECTION_STATE:
+		return sizeof(SaveState);
+	case SECTION_CAMERA:
+		return sizeof(CameraState);
+	case SECTION_BODIES:
+		return sizeof(BodyRecord);
+	case SECTION_ASSETS:
+		return sizeof(AssetRecord);
+	}
+	return 0;
+}
+
+static uint32_t checksum(const unsigned char* data, size_t size)
+{
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= data[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+// replace the file at path with the temporary file
+static bool replaceFile(const char* temporary, const char* path)
+{
+#ifdef _WIN32
+	return MoveFileExA(temporary, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	return rename(temporary, path) == 0;
+#endif
+}
+
+void nameTextures(SaveSnapshot* snapshot)
+{
+	// each image is named once
+	std::map<TextureHandle, int32_t> assetIndex;
+	snapshot->assets.clear();
+	snapshot->bodyAssets.resize(snapshot->bodies.size());
+	for (size_t i = 0; i < snapshot->bodies.size(); i++)
+	{
+		TextureHandle handle = snapshot->bodies[i].textureHandle;
+		std::map<TextureHandle, int32_t>::iterator found = assetIndex.find(handle);
+		if (found != assetIndex.end())
+		{
+			snapshot->bodyAssets[i] = found->second;
+			continue;
+		}
+		TGA* image = TGA::find(handle);
+		int32_t asset = -1;
+		if (image != NULL)
+		{
+			AssetRecord record;
+			memset(&record, 0, sizeof(record));
+			strncpy(record.name, image->getName(), sizeof(record.name) - 1);
+			asset = (int32_t)snapshot->assets.size();
+			snapshot->assets.push_back(record);
+		}
+		assetIndex[handle] = asset;
+		snapshot->bodyAssets[i] = asset;
+	}
+}
+
+bool writeSave(const char* path, const SaveSnapshot& snapshot)
+{
+	const std::vector<AssetRecord>& assets = snapshot.assets;
+	std::vector<BodyRecord> bodies(snapshot.bodies.size());
+	for (size_t i = 0; i < snapshot.bodies.size(); i++)
+	{
+		const BodyDesc& desc = snapshot.bodies[i];
+		BodyRecord& record = bodies[i];
+		record.kind = desc.kind;
+		record.parent = desc.parent;
+		record.distance = desc.distance;
+		record.orbitTime = desc.orbitTime;
+		record.rotationTime = desc.rotationTime;
+		record.radius = desc.radius;
+		record.reserved = 0;
+		record.elements = desc.elements;
+		record.asset = i < snapshot.bodyAssets.size() ? snapshot.bodyAssets[i] : -1;
+	}
+
+	// lay out the sections one after another, each 8-byte aligned
+	SaveSection sections[SECTION_COUNT];
+	const void* contents[SECTION_COUNT] = {&snapshot.state, &snapshot.camera,
+		bodies.empty() ? NULL : &bodies[0], assets.empty() ? NULL : &assets[0]};
+	uint32_t counts[SECTION_COUNT] = {1, 1, (uint32_t)bodies.size(), (uint32_t)assets.size()};
+	uint64_t offset = sizeof(SaveHeader) + sizeof(sections);
+	for (int i = 0; i < SECTION_COUNT; i++)
+	{
+		sections[i].id = i + 1;
+		sections[i].count = counts[i];
+		sections[i].offset = offset;
+		sections[i].length = counts[i] * recordSize(i + 1);
+		offset = (offset + sections[i].length + 7) & ~(uint64_t)7;
+	}
+
+	// the whole save is built in memory and written at once
+	std::vector<unsigned char> buffer((size_t)offset, 0);
+	memcpy(&buffer[sizeof(SaveHeader)], sections, sizeof(sections));
+	for (int i = 0; i < SECTION_COUNT; i++)
+	{
+		if (sections[i].length > 0)
+			memcpy(&buffer[(size_t)sections[i].offset], contents[i], (size_t)sections[i].length);
+	}
+
+	SaveHeader header;
+	memcpy(header.magic, saveMagic, sizeof(saveMagic));
+	header.version = saveVersion;
+	header.headerSize = sizeof(SaveHeader);
+	header.sectionCount = SECTION_COUNT;
+	header.fileSize = offset;
+	header.checksum = checksum(&buffer[sizeof(SaveHeader)], buffer.size() - sizeof(SaveHeader));
+	header.sequence = snapshot.sequence;
+	memcpy(&buffer[0], &header, sizeof(header));
+
+	char temporary[256];
+	snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+	FILE* file = fopen(temporary, "wb");
+	if (file == NULL)
+		return false;
+	bool written = fwrite(&buffer[0], 1, buffer.size(), file) == buffer.size();
+
+	// make sure the data is on the disk before it replaces the old save
+	written = fflush(file) == 0 && written;
+#ifdef _WIN32
+	written = _commit(_fileno(file)) == 0 && written;
+#else
+	written = fsync(fileno(file)) == 0 && written;
+#endif
+	written = fclose(file) == 0 && written;
+	if (!written)
+	{
+		remove(temporary);
+		return false;
+	}
+	return replaceFile(temporary, path);
+}
+
+bool readSave(const char* path, SaveSnapshot* snapshot)
+{
+	MappedFile file;
+	if (!file.open(path))
+		return false;
+	const unsigned char* data = file.getData();
+	size_t size = file.getSize();
+
+	// check the header and the section table
+	if (size < sizeof(SaveHeader))
+		return false;
+	const SaveHeader* header = (const SaveHeader*)data;
+	if (memcmp(header->magic, saveMagic, sizeof(saveMagic)) != 0 || header->version != saveVersion ||
+		header->headerSize != sizeof(SaveHeader) || header->fileSize != size || header->sectionCount > 64 ||
+		sizeof(SaveHeader) + header->sectionCount * sizeof(SaveSection) > size)
+		return false;
+	if (checksum(data + sizeof(SaveHeader), size - sizeof(SaveHeader)) != header->checksum)
+		return false;
+
+	const SaveSection* table = (const SaveSection*)(data + sizeof(SaveHeader));
+	const SaveSection* sections[SECTION_COUNT + 1] = {NULL};
+	for (uint32_t i = 0; i < header->sectionCount; i++)
+	{
+		const SaveSection& section = table[i];
+
+		// sections this version doesn't know about are skipped
+		size_t record = recordSize(section.id);
+		if (record == 0)
+			continue;
+		if (section.offset % 8 != 0 || section.offset > size || section.length > size - section.offset ||
+			section.length != section.count * (uint64_t)record)
+			return false;
+		sections[section.id] = &section;
+	}
+	for (int i = 1; i <= SECTION_COUNT; i++)
+	{
+		if (sections[i] == NULL)
+			return false;
+	}
+	if (sections[SECTION_STATE]->count != 1 || sections[SECTION_CAMERA]->count != 1)
+		return false;
+
+	// check the bodies refer to valid parents and assets
+	const BodyRecord* bodies = (const BodyRecord*)(data + sections[SECTION_BODIES]->offset);
+	const AssetRecord* assets = (const AssetRecord*)(data + sections[SECTION_ASSETS]->offset);
+	int32_t bodyCount = (int32_t)sections[SECTION_BODIES]->count;
+	int32_t assetCount = (int32_t)sections[SECTION_ASSETS]->count;
+	for (int32_t i = 0; i < assetCount; i++)
+	{
+		if (memchr(assets[i].name, 0, sizeof(assets[i].name)) == NULL)
+			return false;
+	}
+	for (int32_t i = 0; i < bodyCount; i++)
+	{
+		const BodyRecord& record = bodies[i];
+		if (record.kind < BODY_PLANET || record.kind >= BODY_KIND_COUNT || record.asset < -1 || record.asset >= assetCount)
+			return false;
+		if (record.kind == BODY_MOON && (record.parent < 0 || record.parent >= i || bodies[record.parent].kind != BODY_PLANET))
+			return false;
+		if (!(record.elements.eccentricity >= 0.0f && record.elements.eccentricity < 1.0f))
+			return false;
+	}
+
+	// the save is sound, so copy it out
+	snapshot->sequence = header->sequence;
+	memcpy(&snapshot->state, data + sections[SECTION_STATE]->offset, sizeof(SaveState));
+	memcpy(&snapshot->camera, data + sections[SECTION_CAMERA]->offset, sizeof(CameraState));
+
+	std::vector<TextureHandle> handles(assetCount, 0);
+	for (int32_t i = 0; i < assetCount; i++)
+	{
+		TGA* image = TGA::find(assets[i].name);
+		if (image != NULL)
+			handles[i] = image->getTextureHandle();
+	}
+	snapshot->assets.assign(assets, assets + assetCount);
+	snapshot->bodyAssets.resize(bodyCount);
+	snapshot->bodies.resize(bodyCount);
+	for (int32_t i = 0; i < bodyCount; i++)
+	{
+		const BodyRecord& record = bodies[i];
+		BodyDesc& desc = snapshot->bodies[i];
+		desc.kind = record.kind;
+		desc.parent = record.kind == BODY_MOON ? record.parent : -1;
+		desc.distance = record.distance;
+		desc.orbitTime = record.orbitTime;
+		desc.rotationTime = record.rotationTime;
+		desc.radius = record.radius;
+		desc.textureHandle = record.asset >= 0 ? handles[record.asset] : 0;
+		snapshot->bodyAssets[i] = record.asset;
+		desc.elements = record.elements;
+	}
+	return true;
+}
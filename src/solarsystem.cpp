@@ -1,257 +1,507 @@
 #include "solarsystem.h"
-#include "tga.h"
+#include <cmath>
+#include "globals.h"
 
-extern double time;
+// the size scaling factor
+float planetSizeScale = 0.000005f;
 
-extern float planetSizeScale;
-
-extern TGA* sun, *mercury, *venus, *earth, *mars, *jupiter, *saturn, *uranus, *neptune, *pluto, *wormhole_pic, *moon, *other_planets[11], *sunPic[3];
-
-SolarSystem::SolarSystem()
+// multiply two column-major 4x4 matrices, result = a * b
+static void multiplyMatrix(float* result, const float* a, const float* b)
 {
-	this->planets.clear();
-	this->wormholes.clear();
-
-	// add all the planets with accurate data. Distance measured in km, time measured in earth days
-	
-	// Sum
-	this->addPlanet(0, 1, 500, 695500, sun->getTextureHandle());
-
-	// Mercury
-	this->addPlanet(57910000, 88, 58.6, 2440, mercury->getTextureHandle());
-
-	// Venus
-	this->addPlanet(108200000, 224.65, 243, 6052, venus->getTextureHandle());
-
-	// Earth
-	this->addPlanet(149600000, 365, 1, 6371, earth->getTextureHandle());
+	for (int column = 0; column < 4; column++)
+	{
+		for (int row = 0; row < 4; row++)
+		{
+			result[column * 4 + row] = a[row] * b[column * 4] + a[4 + row] * b[column * 4 + 1] +
+				a[8 + row] * b[column * 4 + 2] + a[12 + row] * b[column * 4 + 3];
+		}
+	}
+}
 
-	// Mars
-	this->addPlanet(227939100, 686, 1.03f, 3389, mars->getTextureHandle());
+// moves every body along its orbit around its parent and spins it around its axis
+// the turns are counted in doubles and only what is left of the last turn becomes an angle,
+// so bodies move as smoothly after years of warped time as they did at the start
+struct MotionSystem
+{
+	double elapsed;
 
-	// Jupiter
-	this->addPlanet(778500000, 4332, 0.4139, 69911, jupiter->getTextureHandle());
+	template <int Kind, class Traits>
+	void apply(BodyStore& bodies, int i)
+	{
+		// an orbit takes twice the orbit time, as it always has
+		BodyOrbit& orbit = bodies.orbits[i];
+		orbit.phase += elapsed / (2.0 * orbit.orbitTime);
+		orbit.phase -= floor(orbit.phase);
+
+		// find the angle the body would have gone round its orbit if it went evenly
+		bodies.kepler.meanAnomalies[i] = orbit.elements.meanAnomaly * pi / 180.0f + (float)orbit.phase * 2.0f * pi;
+
+		// find the rotation of the body around its axis
+		BodySpin& spin = bodies.spins[i];
+		spin.phase += elapsed / spin.rotationTime;
+		spin.phase -= floor(spin.phase);
+		spin.rotation = Traits::spinSign * (float)spin.phase * 360.0f;
+	}
+};
 
-	// Saturn
-	this->addPlanet(1433000000, 10759, 0.44375, 58232, saturn->getTextureHandle());
+// puts every body on its ellipse, once the solver has found how far round it is
+struct PlacementSystem
+{
+	template <int Kind, class Traits>
+	void apply(BodyStore& bodies, int i)
+	{
+		const BodyOrbit& orbit = bodies.orbits[i];
+		float along = bodies.kepler.cosines[i] - orbit.elements.eccentricity;
+		float across = bodies.kepler.sines[i];
+		BodyPosition& position = bodies.positions[i];
+		position.x = orbit.major[0] * along + orbit.minor[0] * across;
+		position.y = orbit.major[1] * along + orbit.minor[1] * across;
+		position.z = orbit.major[2] * along + orbit.minor[2] * across;
+	}
+};
 
-	// Uranus
-	this->addPlanet(2877000000, 30685, 0.718056, 25362, uranus->getTextureHandle());
+// resolves the hierarchy into world transforms, parents are resolved before their children
+// children follow the position of their parent but not its spin
+struct TransformSystem
+{
+	template <int Kind, class Traits>
+	void apply(BodyStore& bodies, int i)
+	{
+		BodyTransform& transform = bodies.transforms[i];
+		const BodyPosition& position = bodies.positions[i];
+		float* m = transform.matrix;
+
+		float angle = bodies.spins[i].rotation * pi / 180.0f;
+		float c = cos(angle);
+		float s = sin(angle);
+		m[0] = c;    m[4] = -s;   m[8] = 0.0f;  m[12] = position.x * distanceScale;
+		m[1] = s;    m[5] = c;    m[9] = 0.0f;  m[13] = position.y * distanceScale;
+		m[2] = 0.0f; m[6] = 0.0f; m[10] = 1.0f; m[14] = position.z * distanceScale;
+		m[3] = 0.0f; m[7] = 0.0f; m[11] = 0.0f; m[15] = 1.0f;
+
+		int parent = bodies.parents[i];
+		if (parent >= 0)
+		{
+			const float* p = bodies.transforms[parent].matrix;
+			m[12] += p[12];
+			m[13] += p[13];
+			m[14] += p[14];
+		}
 
-	// Neptune
-	this->addPlanet(4503000000, 60188, 0.6713, 24622, neptune->getTextureHandle());
+		// if this is the sun, don't make it too big
+		transform.radius = bodies.radii[i] * planetSizeScale;
+		if (Traits::canBeSun && bodies.orbits[i].distance < 0.001f && transform.radius > 0.5f)
+			transform.radius = 0.5f;
+	}
+};
 
-	// Pluto
-	this->addPlanet(5906380000, 90616, 6.39, 1137, pluto->getTextureHandle());
+// collects the bodies inside the view frustum with their modelview matrices
+struct CullSystem
+{
+	const RenderView* view;
+	std::vector<RenderItem>* items;
 
-	// Moon for the Earth
-	this->addMoon(3, 7000000, 27.3, 27.3, 1738, moon->getTextureHandle());
+	template <int Kind, class Traits>
+	void apply(BodyStore& bodies, int i)
+	{
+		const BodyTransform& transform = bodies.transforms[i];
+		if (!view->contains(&transform.matrix[12], transform.radius))
+			return;
+
+		RenderItem item;
+		multiplyMatrix(item.modelview, view->modelview, transform.matrix);
+		item.radius = transform.radius;
+		item.material = bodies.materials[i];
+
+		// if this is the sun, it's drawn without lighting
+		item.unlit = Traits::canBeSun && bodies.orbits[i].distance < 0.001f;
+		items->push_back(item);
+	}
+};
 
-	// Wormhole
-	this->addWormhole(130000000, 13000000000.0, 0.0130, 13000, wormhole_pic->getTextureHandle());
+void RenderView::translate(const float* offset, RenderView* result) const
+{
+	float translation[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, offset[0], offset[1], offset[2], 1};
+	multiplyMatrix(result->modelview, modelview, translation);
+	for (int i = 0; i < 16; i++)
+	{
+		result->projection[i] = projection[i];
+	}
+	result->updatePlanes();
 }
 
-// a new constructor that generates a random solar system based on time
-SolarSystem::SolarSystem(int mode)
+void RenderView::updatePlanes(void)
 {
-	this->planets.clear();
-	this->wormholes.clear();
+	float clip[16];
+	multiplyMatrix(clip, projection, modelview);
 
-	if (mode != 0)
+	// each plane is the last row of the clip matrix plus or minus one of the others
+	for (int i = 0; i < 6; i++)
 	{
-		return;
+		int row = i / 2;
+		float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+		float length = 0.0f;
+		for (int j = 0; j < 4; j++)
+		{
+			planes[i][j] = clip[j * 4 + 3] + sign * clip[j * 4 + row];
+			if (j < 3)
+				length += planes[i][j] * planes[i][j];
+		}
+		length = sqrt(length);
+		for (int j = 0; j < 4; j++)
+		{
+			planes[i][j] /= length;
+		}
 	}
-	bool flag[11];
-	for (int i = 0; i < 11; i++)
+}
+
+bool RenderView::contains(const float* center, float radius) const
+{
+	for (int i = 0; i < 6; i++)
 	{
-		flag[i] = false;
+		if (planes[i][0] * center[0] + planes[i][1] * center[1] + planes[i][2] * center[2] + planes[i][3] < -radius)
+			return false;
 	}
-	flag[0] = true;
+	return true;
+}
 
-	// set the random number generator
-	srand((int)time);
-	int sun_index = rand() % 3;
+// finds the minimum distance from a point to the surface of the bodies
+struct DistanceSystem
+{
+	const float* position;
+	float minDistance;
 
-	// set up a new solar system based on random numbers
-	this->addPlanet(0, 1, 500, 695500, sunPic[sun_index]->getTextureHandle());
-	int solar_size = rand() % 5 + 5;
-	float distancefromSun = 0;
+	// skip the kinds that do not collide
+	bool solidOnly;
 
-	// loop over all planets
-	while (solar_size--)
+	template <int Kind, class Traits>
+	void apply(BodyStore& bodies, int i)
 	{
-		int index = rand() % 12;
-		while (flag[index])
+		if (solidOnly && !Traits::collides)
+			return;
+
+		// calculate the distance from the body's center
+		const BodyTransform& transform = bodies.transforms[i];
+		float dx = transform.matrix[12] - position[0];
+		float dy = transform.matrix[13] - position[1];
+		float dz = transform.matrix[14] - position[2];
+		float distance = sqrt(dx * dx + dy * dy + dz * dz) - transform.radius;
+
+		// find the global minimum
+		if (minDistance > distance)
 		{
-			index = rand() % 12;
+			minDistance = distance;
 		}
-		
-		// if this is exactly the Sun
-		if (distancefromSun < 0.001f)
+	}
+};
+
+// finds the nearest body hit by a ray
+struct PickSystem
+{
+	const float* origin;
+
+	// normalized direction of the ray
+	const float* direction;
+	float nearest;
+	int index;
+
+	template <int Kind, class Traits>
+	void apply(BodyStore& bodies, int i)
+	{
+		const BodyTransform& transform = bodies.transforms[i];
+		float offset[3] = {transform.matrix[12] - origin[0], transform.matrix[13] - origin[1], transform.matrix[14] - origin[2]};
+
+		// closest approach of the ray to the center
+		float along = offset[0] * direction[0] + offset[1] * direction[1] + offset[2] * direction[2];
+		if (along <= 0.0f || along >= nearest)
+			return;
+		float squared = offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2] - along * along;
+		if (squared > transform.radius * transform.radius)
+			return;
+
+		nearest = along;
+		index = i;
+	}
+};
+
+SolarSystem::SolarSystem(const std::vector<BodyDesc>& descriptions)
+{
+	bodies.reserve((int)descriptions.size());
+
+	// bodies are stored kind by kind, moons refer to their planet by the index of its description
+	std::vector<int> index(descriptions.size(), -1);
+	for (int kind = 0; kind < BODY_KIND_COUNT; kind++)
+	{
+		for (int i = 0; i < descriptions.size(); i++)
 		{
-			float distance = (rand() + 1000) * (rand() + 1000);
-			while (distance < 57910000 || distance > 120000000)
-			{
-				distance = (rand() + 1000) * (rand() + 1000);
-			}
-			distancefromSun = distancefromSun + distance;
-			this->addPlanet(distancefromSun, rand() % 1000 + 100, (float)(rand() + 1000) / 8000, 
-				rand() % 1500 + 3000, other_planets[index]->getTextureHandle());
-		}
-		
-		// this is a normal planet
-		else{
-			float distance = (rand() + 1000) * (rand() + 1000);
-			while (distance < 57910000 || distance > 120000000)
+			const BodyDesc& desc = descriptions[i];
+			if (desc.kind != kind)
+				continue;
+
+			int parent = -1;
+			if (kind == BODY_MOON)
 			{
-				distance = (rand() + 1000) * (rand() + 1000);
+				if (desc.parent < 0 || desc.parent >= i || descriptions[desc.parent].kind != BODY_PLANET)
+					continue;
+				parent = index[desc.parent];
 			}
-			distancefromSun = distancefromSun + distance;
-			this->addPlanet(distancefromSun, rand() % 1000 + 100, (float)(rand() + 1000) / 8000, 
-				rand() % 20000 + 5000, other_planets[index]->getTextureHandle());
+			index[i] = bodies.add(kind, parent, desc.distance, desc.orbitTime, desc.rotationTime, desc.radius, desc.textureHandle,
+				desc.elements);
 		}
-		flag[index] = true;
 	}
+}
 
-	// add a new wormhole
-	this->addWormhole(130000000, 13000000000.0, 0.0130, 13000, wormhole_pic->getTextureHandle());
+void SolarSystem::calculatePositions(const SimulationTime& time)
+{
+	MotionSystem motion = {time.since(clock)};
+	clock = time;
+	bodies.runAll(motion);
+	bodies.kepler.solve();
+	PlacementSystem placement;
+	bodies.runAll(placement);
+	TransformSystem transforms;
+	bodies.runAll(transforms);
 }
 
-void SolarSystem::calculatePositions(float time)
+void SolarSystem::buildRenderList(const RenderView& view, std::vector<RenderItem>& items)
 {
-	for (int i = 0; i < planets.size(); i++)
-	{
-		planets[i].calculatePosition(time);
-	}
-	for (int i = 0; i < wormholes.size(); i++)
-	{
-		wormholes[i].calculatePosition(time);
-	}
+	items.clear();
+	CullSystem culler = {&view, &items};
+	bodies.runAll(culler);
 }
 
-void SolarSystem::addPlanet(float distanceFromSun, float orbitTime, float rotationTime, float radius, GLuint textureHandle)
+void SolarSystem::getPlanetPosition(int index, float* vec)
 {
-	planets.push_back(Planet(distanceFromSun, orbitTime, rotationTime, radius, textureHandle));
+	const float* m = bodies.transforms[bodies.begin(BODY_PLANET) + index].matrix;
+	vec[0] = m[12];
+	vec[1] = m[13];
+	vec[2] = m[14];
 }
 
-void SolarSystem::addWormhole(float distanceFromSun, float orbitTime, float rotationTime, float radius, GLuint textureHandle)
+int SolarSystem::getBodyCount(void)
 {
-	wormholes.push_back(Wormhole(distanceFromSun, orbitTime, rotationTime, radius, textureHandle));
+	return bodies.size();
 }
 
-void SolarSystem::addMoon(int planetIndex, float distanceFromPlanet, float orbitTime, float rotationTime, float radius, GLuint textureHandle)
+void SolarSystem::getBodyPosition(int index, float* position)
 {
-	planets[planetIndex].addMoon(distanceFromPlanet, orbitTime, rotationTime, radius, textureHandle);
+	const float* m = bodies.transforms[index].matrix;
+	position[0] = m[12];
+	position[1] = m[13];
+	position[2] = m[14];
 }
 
-void SolarSystem::render()
+float SolarSystem::getRadiusOfPlanet(int index)
 {
-	for (int i = 0; i < wormholes.size(); i++)
-	{
-		wormholes[i].render();
-	}
-	for (int i = 0; i < planets.size(); i++)
-	{
-		planets[i].render();
-	}
+	return bodies.radii[bodies.begin(BODY_PLANET) + index];
 }
 
-void SolarSystem::renderOrbits()
+// check the minimum distance with all planets and moons
+float SolarSystem::testDistancewithPlanet(Camera camera)
 {
-	glDisable(GL_TEXTURE_2D);
-	for (int i = 0; i < planets.size(); i++)
-	{
-		planets[i].renderOrbit();
-	}
-	glEnable(GL_TEXTURE_2D);
+	return testDistancewithPlanet(camera.position);
 }
 
-void SolarSystem::getPlanetPosition(int index, float* vec)
+float SolarSystem::testDistancewithPlanet(const float* position)
 {
-	planets[index].getPosition(vec);
+	DistanceSystem distance = {position, 10000.0f, true};
+	bodies.runAll(distance);
+	return distance.minDistance;
 }
 
-float SolarSystem::getRadiusOfPlanet(int index)
+// check the minimum distance with all wormholes
+float SolarSystem::testDistancewithWormhole(Camera camera)
 {
-	return planets[index].getRadius();
+	return testDistancewithWormhole(camera.position);
 }
 
-// check the minimum distance with all planets
-float SolarSystem::testDistancewithPlanet(Camera camera)
+float SolarSystem::testDistancewithWormhole(const float* position)
+{
+	DistanceSystem distance = {position, 10000.0f, false};
+	bodies.run<BODY_WORMHOLE>(distance);
+	return distance.minDistance;
+}
+
+float SolarSystem::getDistanceToPlanet(int index, const float* position)
 {
-	float position[3];
-	for (int i = 0; i < 3; i++)
+	const BodyTransform& transform = bodies.transforms[bodies.begin(BODY_PLANET) + index];
+	float dx = transform.matrix[12] - position[0];
+	float dy = transform.matrix[13] - position[1];
+	float dz = transform.matrix[14] - position[2];
+	return sqrt(dx * dx + dy * dy + dz * dz) - transform.radius;
+}
+
+int SolarSystem::pick(const float* origin, const float* direction, float* center)
+{
+	PickSystem picker = {origin, direction, 10000.0f, -1};
+	bodies.runAll(picker);
+	if (picker.index < 0)
+		return -1;
+
+	const float* m = bodies.transforms[picker.index].matrix;
+	center[0] = m[12];
+	center[1] = m[13];
+	center[2] = m[14];
+	return picker.index;
+}
+
+bool SolarSystem::hasPlanet(unsigned char index)
+{
+	int x = index - '0';
+	if (x < bodies.count(BODY_PLANET))
+		return true;
+	return false;
+}
+
+size_t SolarSystem::getMemoryFootprint(void)
+{
+	return sizeof(SolarSystem) + bodies.getMemoryFootprint();
+}
+
+void SolarSystem::getGravityBodies(const SimulationTime& time, std::vector<GravityBody>& states)
+{
+	calculatePositions(time);
+	int count = bodies.size();
+	states.resize(count);
+
+	// the sun and the innermost planet set the scale of all masses
+	int sun = -1, innermost = -1;
+	for (int i = bodies.begin(BODY_PLANET); i < bodies.end(BODY_PLANET); i++)
 	{
-		position[i] = camera.position[i];
+		if (bodies.orbits[i].distance < 0.001f)
+		{
+			if (sun < 0)
+				sun = i;
+		}
+		else if (innermost < 0 || bodies.orbits[i].distance < bodies.orbits[innermost].distance)
+		{
+			innermost = i;
+		}
+	}
+	double sunMass = 0.0, sunRadius = 1.0;
+	if (sun >= 0 && innermost >= 0)
+	{
+		// a circular orbit of radius r and angular speed w needs a mass of w * w * r * r * r
+		double speed = pi / bodies.orbits[innermost].orbitTime;
+		double r = bodies.orbits[innermost].distance * distanceScale;
+		sunMass = speed * speed * r * r * r;
+		sunRadius = bodies.radii[sun];
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		double scale = bodies.radii[i] / sunRadius;
+		states[i].mass = sunMass * scale * scale * scale;
 	}
-	float min_distance = 10000.0f;
 
-	// loop over all planets
-	for (int i = 0; i < planets.size(); i++)
+	// planets with moons are heavy enough to keep them, or the sun would pull them away
+	for (int i = bodies.begin(BODY_MOON); i < bodies.end(BODY_MOON); i++)
 	{
-		float pos[3] = {1, 1, 1};
-		planets[i].getPosition(pos);
-		float distance = 0;
+		int parent = bodies.parents[i];
+		double speed = pi / bodies.orbits[i].orbitTime;
+		double r = bodies.orbits[i].distance * distanceScale;
+		if (parent >= 0 && states[parent].mass < speed * speed * r * r * r)
+			states[parent].mass = speed * speed * r * r * r;
+	}
 
-		// calculate the distance from each planet's center
+	for (int i = 0; i < count; i++)
+	{
+		GravityBody& state = states[i];
+		const float* m = bodies.transforms[i].matrix;
 		for (int j = 0; j < 3; j++)
 		{
-			distance = distance + (pos[j] - position[j]) * (pos[j] - position[j]);
+			state.position[j] = m[12 + j];
+			state.velocity[j] = 0.0;
 		}
-		distance = sqrt(distance);
-		float radiusScale = planets[i].getRadius() * planetSizeScale;
-		if (radiusScale > 0.5f)
+
+		// parents come first, so their state is known already
+		int parent = bodies.parents[i];
+		double center[3] = {0.0, 0.0, 0.0}, centralMass = sunMass;
+		if (parent >= 0)
+		{
+			centralMass = states[parent].mass;
+			for (int j = 0; j < 3; j++)
+			{
+				center[j] = states[parent].position[j];
+				state.velocity[j] = states[parent].velocity[j];
+			}
+		}
+		else if (i == sun)
 		{
-			radiusScale = 0.5f;
+			continue;
 		}
 
-		// find the global minimum
-		if (min_distance > distance - radiusScale)
+		// go the way the analytic orbit goes, as fast as a body on that ellipse is at this distance
+		const BodyOrbit& orbit = bodies.orbits[i];
+		double direction[3], length = 0.0, r = 0.0;
+		for (int j = 0; j < 3; j++)
+		{
+			direction[j] = orbit.minor[j] * bodies.kepler.cosines[i] - orbit.major[j] * bodies.kepler.sines[i];
+			length += direction[j] * direction[j];
+			r += (state.position[j] - center[j]) * (state.position[j] - center[j]);
+		}
+		r = sqrt(r);
+		length = sqrt(length);
+		double axis = orbit.distance * distanceScale;
+		if (r <= 0.0 || length <= 0.0 || axis <= 0.0)
+			continue;
+		double speed = sqrt(fmax(0.0, centralMass * (2.0 / r - 1.0 / axis)));
+		for (int j = 0; j < 3; j++)
 		{
-			min_distance = distance - radiusScale;
+			state.velocity[j] += direction[j] / length * speed;
 		}
 	}
-	return min_distance;
 }
 
-// check the minimum distance with all wormholes
-float SolarSystem::testDistancewithWormhole(Camera camera)
+void SolarSystem::placeBodies(GravitySimulation& simulation, int first, const SimulationTime& time)
 {
-	float position[3];
-	for (int i = 0; i < 3; i++)
+	calculatePositions(time);
+	GravityBody state;
+	for (int i = 0; i < bodies.size(); i++)
 	{
-		position[i] = camera.position[i];
+		simulation.getBody(first + i, &state);
+		float* m = bodies.transforms[i].matrix;
+		m[12] = (float)state.position[0];
+		m[13] = (float)state.position[1];
+		m[14] = (float)state.position[2];
 	}
-	float min_distance = 10000.0f;
+}
 
-	// loop over all wormholes
-	for (int i = 0; i < wormholes.size(); i++)
+void SolarSystem::describe(std::vector<BodyDesc>& descriptions)
+{
+	descriptions.clear();
+	for (int kind = 0; kind < BODY_KIND_COUNT; kind++)
 	{
-		float pos[3] = {1, 1, 1};
-		wormholes[i].getPosition(pos);
-		float distance = 0;
+		// moons are described right after their planet
+		if (kind == BODY_MOON)
+			continue;
 
-		// calculate the distance from each wormhole's center
-		for (int j = 0; j < 3; j++)
+		for (int i = bodies.begin(kind); i < bodies.end(kind); i++)
 		{
-			distance = distance + (pos[j] - position[j]) * (pos[j] - position[j]);
-		}
-		distance = sqrt(distance);
-		float radiusScale = wormholes[i].getRadius() * planetSizeScale;
+			describeBody(i, -1, descriptions);
+			if (kind != BODY_PLANET)
+				continue;
 
-		// find the global minimum 
-		if (min_distance > distance - radiusScale)
-		{
-			min_distance = distance - radiusScale;
+			int parent = (int)descriptions.size() - 1;
+			for (int j = bodies.begin(BODY_MOON); j < bodies.end(BODY_MOON); j++)
+			{
+				if (bodies.parents[j] == i)
+					describeBody(j, parent, descriptions);
+			}
 		}
 	}
-	return min_distance;
 }
 
-bool SolarSystem::hasPlanet(unsigned char index)
+void SolarSystem::describeBody(int index, int parent, std::vector<BodyDesc>& descriptions)
 {
-	int x = index - '0';
-	if (x < planets.size())
-		return true;
-	return false;
-}
\ No newline at end of file
+	BodyDesc desc;
+	desc.kind = bodies.kinds[index];
+	desc.parent = parent;
+	desc.distance = bodies.orbits[index].distance;
+	desc.orbitTime = bodies.orbits[index].orbitTime;
+	desc.rotationTime = bodies.spins[index].rotationTime;
+	desc.radius = bodies.radii[index];
+	desc.textureHandle = bodies.materials[index];
+	desc.elements = bodies.orbits[index].elements;
+	descriptions.push_back(desc);
+}
@@ -0,0 +1,119 @@
+#include "solarsystem.h"
+#include <cmath>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+#include <glut.h>
+#include "globals.h"
+#include "metrics.h"
+#include "glcount.h"
+
+// detail of the spheres of the bodies
+static const int sphereSlices = 30;
+static const int sphereStacks = 30;
+
+// draws the orbit of every body that has one around its sun or parent
+struct OrbitSystem
+{
+	template <int Kind, class Traits>
+	void apply(BodyStore& bodies, int i)
+	{
+		if (Traits::orbitStep <= 0.0f)
+			return;
+
+		float center[3] = {0.0f, 0.0f, 0.0f};
+		int parent = bodies.parents[i];
+		if (parent >= 0)
+		{
+			const float* p = bodies.transforms[parent].matrix;
+			center[0] = p[12];
+			center[1] = p[13];
+			center[2] = p[14];
+		}
+
+		// go round the ellipse evenly in the eccentric anomaly and close it where it started
+		const BodyOrbit& orbit = bodies.orbits[i];
+		int vertices = 1;
+		glBegin(GL_LINE_STRIP);
+		for (float angle = 0.0f; angle < 2.0f * pi; angle += Traits::orbitStep)
+		{
+			vertex(orbit, center, cos(angle), sin(angle));
+			vertices++;
+		}
+		vertex(orbit, center, 1.0f, 0.0f);
+		glEnd();
+		verticesSubmitted.add(vertices);
+	}
+
+	void vertex(const BodyOrbit& orbit, const float* center, float cosine, float sine)
+	{
+		float along = cosine - orbit.elements.eccentricity;
+		glVertex3f(center[0] + (orbit.major[0] * along + orbit.minor[0] * sine) * distanceScale,
+			center[1] + (orbit.major[1] * along + orbit.minor[1] * sine) * distanceScale,
+			center[2] + (orbit.major[2] * along + orbit.minor[2] * sine) * distanceScale);
+	}
+};
+
+void RenderView::capture(void)
+{
+	glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+	glGetFloatv(GL_PROJECTION_MATRIX, projection);
+	updatePlanes();
+}
+
+void SolarSystem::render()
+{
+	RenderView view;
+	view.capture();
+	std::vector<RenderItem> items;
+	buildRenderList(view, items);
+	submit(items);
+}
+
+void SolarSystem::submit(const std::vector<RenderItem>& items)
+{
+	// one quadric serves all spheres
+	GLUquadricObj* quadric = gluNewQuadric();
+	gluQuadricTexture(quadric, true);
+	gluQuadricNormals(quadric, GLU_SMOOTH);
+
+	// load the matrix of every body directly instead of going through the matrix stack
+	glPushMatrix();
+	for (int i = 0; i < items.size(); i++)
+	{
+		const RenderItem& item = items[i];
+		glLoadMatrixf(item.modelview);
+		glBindTexture(GL_TEXTURE_2D, item.material);
+		if (item.unlit)
+		{
+			glDisable(GL_LIGHTING);
+			gluSphere(quadric, item.radius, sphereSlices, sphereStacks);
+			glEnable(GL_LIGHTING);
+		}
+		else
+		{
+			gluSphere(quadric, item.radius, sphereSlices, sphereStacks);
+		}
+	}
+	glPopMatrix();
+	gluDeleteQuadric(quadric);
+
+	// a sphere is drawn as one strip of quads for every stack
+	verticesSubmitted.add(items.size() * sphereStacks * (sphereSlices + 1) * 2);
+}
+
+void SolarSystem::renderOrbits()
+{
+	glDisable(GL_TEXTURE_2D);
+	OrbitSystem orbits;
+	bodies.runAll(orbits);
+	glEnable(GL_TEXTURE_2D);
+}
+
+void SolarSystem::makeResident(void)
+{
+	std::vector<GLclampf> priorities(bodies.size(), 1.0f);
+	if (bodies.size() > 0)
+		glPrioritizeTextures((GLsizei)bodies.size(), &bodies.materials[0], &priorities[0]);
+}
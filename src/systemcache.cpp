@@ -0,0 +1,73 @@
+#include "systemcache.h"
+
+SystemCache::SystemCache(size_t budget)
+{
+	this->budget = budget;
+	this->used = 0;
+}
+
+SystemCache::~SystemCache(void)
+{
+	for (std::list<Entry>::iterator i = entries.begin(); i != entries.end(); i++)
+	{
+		delete i->system;
+	}
+}
+
+bool SystemCache::contains(uint64_t id)
+{
+	return index.find(id) != index.end();
+}
+
+SolarSystem* SystemCache::take(uint64_t id)
+{
+	std::map<uint64_t, std::list<Entry>::iterator>::iterator found = index.find(id);
+	if (found == index.end())
+		return NULL;
+
+	SolarSystem* system = found->second->system;
+	used -= found->second->bytes;
+	entries.erase(found->second);
+	index.erase(found);
+	return system;
+}
+
+void SystemCache::put(uint64_t id, SolarSystem* system, std::vector<SolarSystem*>& evicted)
+{
+	// a system with the same id is replaced by the newer one
+	SolarSystem* old = take(id);
+	if (old != NULL)
+		evicted.push_back(old);
+
+	Entry entry;
+	entry.id = id;
+	entry.system = system;
+	entry.bytes = system->getMemoryFootprint();
+	entries.push_front(entry);
+	index[id] = entries.begin();
+	used += entry.bytes;
+	trim(evicted);
+}
+
+void SystemCache::setBudget(size_t budget, std::vector<SolarSystem*>& evicted)
+{
+	this->budget = budget;
+	trim(evicted);
+}
+
+size_t SystemCache::getUsed(void)
+{
+	return used;
+}
+
+void SystemCache::trim(std::vector<SolarSystem*>& evicted)
+{
+	while (used > budget && !entries.empty())
+	{
+		Entry& oldest = entries.back();
+		used -= oldest.bytes;
+		evicted.push_back(oldest.system);
+		index.erase(oldest.id);
+		entries.pop_back();
+	}
+}
@@ -0,0 +1,90 @@
+#include "systemgenerator.h"
+#include "random.h"
+
+// limits of the generated systems
+static const int minPlanets = 5;
+static const int maxPlanets = 9;
+static const float minSpacing = 57910000.0f;
+static const float maxSpacing = 120000000.0f;
+static const float maxEccentricity = 0.1f;
+static const float maxInclination = 4.0f;
+
+SystemGenerator::SystemGenerator(const std::vector<TextureHandle>& suns, const std::vector<TextureHandle>& planets, TextureHandle wormhole)
+{
+	this->suns = suns;
+	this->planets = planets;
+	this->wormhole = wormhole;
+}
+
+// fill in a body orbiting the sun
+static void setBody(BodyDesc* desc, int kind, float distance, float orbitTime, float rotationTime, float radius, TextureHandle textureHandle)
+{
+	desc->kind = kind;
+	desc->parent = -1;
+	desc->distance = distance;
+	desc->orbitTime = orbitTime;
+	desc->rotationTime = rotationTime;
+	desc->radius = radius;
+	desc->textureHandle = textureHandle;
+	desc->elements.eccentricity = 0.0f;
+	desc->elements.inclination = 0.0f;
+	desc->elements.ascendingNode = 0.0f;
+	desc->elements.periapsis = 0.0f;
+	desc->elements.meanAnomaly = 0.0f;
+}
+
+// tilt and stretch the orbit of a planet a little
+static void setElements(BodyDesc* desc, Random& random)
+{
+	desc->elements.eccentricity = random.uniform(0.0f, maxEccentricity);
+	desc->elements.inclination = random.uniform(0.0f, maxInclination);
+	desc->elements.ascendingNode = random.uniform(0.0f, 360.0f);
+	desc->elements.periapsis = random.uniform(0.0f, 360.0f);
+	desc->elements.meanAnomaly = random.uniform(0.0f, 360.0f);
+}
+
+void SystemGenerator::generate(uint64_t seed, std::vector<BodyDesc>& bodies) const
+{
+	Random random(seed);
+	bodies.clear();
+
+	// the orbits come from a stream of their own, so the rest of a system is what the seed always gave
+	Random shapes(Random::combine(seed, 1));
+
+	// the sun
+	BodyDesc desc;
+	setBody(&desc, BODY_PLANET, 0, 1, 500, 695500, suns.empty() ? 0 : suns[random.range((int)suns.size())]);
+	bodies.push_back(desc);
+
+	// deal the planet textures without replacement, so no two planets look the same
+	int count = minPlanets + random.range(maxPlanets - minPlanets + 1);
+	if (count > planets.size())
+		count = (int)planets.size();
+	TextureHandle deck[64];
+	int deckSize = planets.size() < 64 ? (int)planets.size() : 64;
+	for (int i = 0; i < deckSize; i++)
+	{
+		deck[i] = planets[i];
+	}
+
+	float distanceFromSun = 0;
+	for (int i = 0; i < count; i++)
+	{
+		int pick = i + random.range(deckSize - i);
+		TextureHandle texture = deck[pick];
+		deck[pick] = deck[i];
+		deck[i] = texture;
+
+		// the innermost planet is a small one
+		distanceFromSun += random.uniform(minSpacing, maxSpacing);
+		float orbitTime = (float)(random.range(1000) + 100);
+		float rotationTime = random.uniform(1000.0f, 33768.0f) / 8000.0f;
+		float radius = i == 0 ? (float)(random.range(1500) + 3000) : (float)(random.range(20000) + 5000);
+		setBody(&desc, BODY_PLANET, distanceFromSun, orbitTime, rotationTime, radius, texture);
+		setElements(&desc, shapes);
+		bodies.push_back(desc);
+	}
+
+	setBody(&desc, BODY_WORMHOLE, 130000000, 13000000000.0f, 0.0130f, 13000, wormhole);
+	bodies.push_back(desc);
+}
@@ -1,11 +1,15 @@
 #include "tga.h"
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <vector>
 
 #ifdef _WIN32
 #include <Windows.h>
 #endif
 #include <glut.h>
+#include "metrics.h"
+#include "mappedfile.h"
 
 // The following is a header for the TGA header, storing information about a TGA file.
 #pragma pack(1)
@@ -25,123 +29,165 @@ struct TGAHeader{
 };
 #pragma pack()
 
-TGA::TGA(char* imagePath)
+// all images loaded so far
+static std::vector<TGA*> loadedImages;
+
+TGA::TGA(const char* imagePath)
 {
-    FILE* file = NULL;
-    TGAHeader header;
-    char* pixels, *buffer;
+	strncpy(name, imagePath, sizeof(name) - 1);
+	name[sizeof(name) - 1] = 0;
+	loadedImages.push_back(this);
+
+	TGAImage image;
+	MappedFile file;
+	bool decoded = file.open(imagePath) && decode(file.getData(), file.getSize(), &image);
+	file.close();
 
-	int c, r, i, j, bytespp = 4;
-    char n, packet_header;
-    char pixel[4];
+	// OpenGL texture
+	glGenTextures(1, &textureHandle);
+	glBindTexture(GL_TEXTURE_2D, textureHandle);
+	glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-    file = fopen(imagePath, "rb");
-	fread(&header, 18, 1, file);
+	// a broken image leaves the texture empty
+	if (!decoded)
+	{
+		fprintf(stderr, "can't load the image %s\n", imagePath);
+		return;
+	}
+	gluBuild2DMipmaps(GL_TEXTURE_2D, 3, image.width, image.height, GL_RGB, GL_UNSIGNED_BYTE, &image.pixels[0]);
+
+	// the mipmaps add a third to the image
+	double bytes = (double)image.width * image.height * 3 * 4 / 3;
+	bytesUploaded.add((int64_t)bytes);
+	textureMemory.add(bytes);
+}
+
+// copy one pixel of the file, which holds blue, green, red and alpha, into the image
+static void storePixel(unsigned char* destination, const unsigned char* source, int bytespp)
+{
+	destination[0] = source[2];
+	destination[1] = source[1];
+	destination[2] = source[0];
+	if (bytespp == 4)
+		destination[3] = source[3];
+}
+
+bool TGA::decode(const unsigned char* data, size_t size, TGAImage* image)
+{
+	TGAHeader header;
+	if (size < sizeof(header))
+		return false;
+	memcpy(&header, data, sizeof(header));
 
 	// # bytes per pixel
-    bytespp = header.bpp / 8;
-	pixels = (char*)malloc(bytespp * header.width * header.height);
+	int bytespp = header.bpp / 8;
+	if ((bytespp != 3 && bytespp != 4) || header.width <= 0 || header.height <= 0)
+		return false;
+	int width = header.width;
+	int height = header.height;
+	size_t offset = sizeof(header) + header.map_start + header.map_length * bytespp;
+	if (offset > size)
+		return false;
+	const unsigned char* source = data + offset;
+	const unsigned char* end = data + size;
 
-    // header type 2 is uncompressed RGB da5ta without a color map
-    if (header.type == 2)
+	image->width = width;
+	image->height = height;
+	image->bytesPerPixel = bytespp;
+	image->pixels.resize((size_t)bytespp * width * height);
+	unsigned char* pixels = &image->pixels[0];
+
+	// header type 2 is uncompressed RGB data without a color map, its rows are flipped
+	if (header.type == 2)
 	{
-        fseek(file, header.map_start + header.map_length * bytespp + 18, SEEK_SET);
-        buffer = (char*)malloc(bytespp * header.width * header.height);
-        fread(buffer, bytespp, header.width * header.height, file);
-        for (c = 0; c < header.width; c ++)
+		if ((size_t)(end - source) < image->pixels.size())
+			return false;
+		for (int r = 0; r < height; r++)
 		{
-            for (r = 0; r < header.height; r ++)
+			unsigned char* row = pixels + (size_t)(height - r - 1) * width * bytespp;
+			for (int c = 0; c < width; c++)
 			{
-                if (bytespp == 4)
-				{
-                    pixels[(c + (header.height - r - 1) * header.width) * bytespp + 0] =
-                        buffer[(c + r * header.width) * bytespp + 2];
-                    pixels[(c + (header.height - r - 1) * header.width) * bytespp + 1] =
-                        buffer[(c + r * header.width) * bytespp + 1];
-                    pixels[(c + (header.height - r - 1) * header.width) * bytespp + 2] =
-                        buffer[(c + r * header.width) * bytespp + 0];
-                    pixels[(c + (header.height - r - 1) * header.width) * bytespp + 3] =
-                        buffer[(c + r * header.width) * bytespp + 3];
-                }
-				else if (bytespp == 3)
-				{
-                    pixels[(c + (header.height - r - 1) * header.width) * bytespp + 0] =
-                        buffer[(c + r * header.width) * bytespp + 2];
-                    pixels[(c + (header.height - r - 1) * header.width) * bytespp + 1] =
-                        buffer[(c + r * header.width) * bytespp + 1];
-                    pixels[(c + (header.height - r - 1) * header.width) * bytespp + 2] =
-                        buffer[(c + r * header.width) * bytespp + 0];
-                }
-            }
-        }
-
-        free(buffer);
-
-    } 
-
-	// Run Length Encoding, non-color mapped RGB
-	else if (header.type == 10)
+				storePixel(row + c * bytespp, source, bytespp);
+				source += bytespp;
+			}
+		}
+		return true;
+	}
+
+	// Run Length Encoding, non-color mapped RGB, filled from the last row up
+	if (header.type == 10)
 	{
-        fseek(file, header.map_start + header.map_length * bytespp + 18, SEEK_SET);
-        c = 0; r = header.height - 1; 
-        while (r >= 0)
+		int c = 0, r = height - 1;
+		while (r >= 0)
 		{
-            fread(&packet_header, sizeof(packet_header), 1, file);
-
-            // find the number of repititions
-            n = packet_header & 0x7F;
-            *((int*)pixel) = 0;
-            if (n != packet_header)
-                fread(&pixel, bytespp, 1, file);
-            for (i = 0; i < n + 1; i++)
+			if (source >= end)
+				return false;
+			unsigned char packetHeader = *source++;
+
+			// find the number of repetitions
+			int n = (packetHeader & 0x7F) + 1;
+			bool repeated = (packetHeader & 0x80) != 0;
+			unsigned char pixel[4] = {0, 0, 0, 0};
+			if (repeated)
 			{
-                if (n == packet_header)
-                    fread(&pixel, bytespp, 1, file);
-                if (bytespp == 4)
-				{
-                    pixels[(c + r * header.width) * bytespp + 0] =
-                        pixel[2];
-                    pixels[(c + r * header.width) * bytespp + 1] =
-                        pixel[1];
-                    pixels[(c + r * header.width) * bytespp + 2] =
-                        pixel[0];
-                    pixels[(c + r * header.width) * bytespp + 3] =
-                        pixel[3];
-                }
-				else if (bytespp == 3)
+				if (end - source < bytespp)
+					return false;
+				memcpy(pixel, source, bytespp);
+				source += bytespp;
+			}
+			for (int i = 0; i < n && r >= 0; i++)
+			{
+				if (!repeated)
 				{
-                    pixels[(c + r * header.width) * bytespp + 0] =
-                        pixel[2];
-                    pixels[(c + r * header.width) * bytespp + 1] =
-                        pixel[1];
-                    pixels[(c + r * header.width) * bytespp + 2] =
-                        pixel[0];
-                }
-                c += 1;
-                if (c >= header.width)
+					if (end - source < bytespp)
+						return false;
+					memcpy(pixel, source, bytespp);
+					source += bytespp;
+				}
+				storePixel(pixels + ((size_t)r * width + c) * bytespp, pixel, bytespp);
+				c += 1;
+				if (c >= width)
 				{
-                    c = 0;
-                    r -= 1;
-                }
-            }
-        }
-    }
-    fclose(file);
-
-	// OpenGL texture
-	glGenTextures(1, &textureHandle);
-	glBindTexture(GL_TEXTURE_2D, textureHandle);
-	glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	gluBuild2DMipmaps(GL_TEXTURE_2D, 3, header.width, header.height, GL_RGB, GL_UNSIGNED_BYTE, pixels);
-
-	free(pixels);
+					c = 0;
+					r -= 1;
+				}
+			}
+		}
+		return true;
+	}
+	return false;
 }
 
 GLuint TGA::getTextureHandle(void)
 {
 	return textureHandle;
 }
+
+const char* TGA::getName(void)
+{
+	return name;
+}
+
+TGA* TGA::find(const char* name)
+{
+	for (int i = 0; i < loadedImages.size(); i++)
+	{
+		if (strcmp(loadedImages[i]->name, name) == 0)
+			return loadedImages[i];
+	}
+	return NULL;
+}
+
+TGA* TGA::find(GLuint textureHandle)
+{
+	for (int i = 0; i < loadedImages.size(); i++)
+	{
+		if (loadedImages[i]->textureHandle == textureHandle)
+			return loadedImages[i];
+	}
+	return NULL;
+}
@@ -0,0 +1,323 @@
+#include "trails.h"
+#include <cstring>
+#include "metrics.h"
+#include "glcount.h"
+
+// texels of the fade from the oldest point to the newest
+static const int fadeSize = 64;
+
+// nanoseconds to wait for the card at a time before asking again
+static const GLuint64 fenceTimeout = 1000000;
+
+TrailSet::TrailSet(int trailCount, int length)
+{
+	this->trailCount = trailCount;
+	this->length = length;
+	stride = length + 1;
+	points.assign((size_t)trailCount * stride * 3, 0.0f);
+	counts.assign(trailCount, 0);
+	origin[0] = origin[1] = origin[2] = 0.0f;
+	sample = 0;
+
+	mode = MODE_NONE;
+	vertexBuffer = 0;
+	coordinateBuffer = 0;
+	fadeTexture = 0;
+	mapped = NULL;
+	copy = 0;
+	for (int i = 0; i < copyCount; i++)
+	{
+		synced[i] = 0;
+		fences[i] = NULL;
+	}
+
+	// every slot fades the same way in every trail, so the coordinates never change
+	coordinates.resize((size_t)trailCount * stride);
+	for (int i = 0; i < trailCount; i++)
+	{
+		for (int j = 0; j < stride; j++)
+		{
+			coordinates[(size_t)i * stride + j] = (float)j / length;
+		}
+	}
+	for (int i = 0; i < 2; i++)
+	{
+		firsts[i].resize(trailCount);
+		sizes[i].resize(trailCount);
+	}
+}
+
+TrailSet::~TrailSet(void)
+{
+	GLExtensions& gl = glExtensions;
+	for (int i = 0; i < copyCount; i++)
+	{
+		if (fences[i] != NULL)
+			gl.deleteSync(fences[i]);
+	}
+	if (vertexBuffer != 0)
+		gl.deleteBuffers(1, &vertexBuffer);
+	if (coordinateBuffer != 0)
+		gl.deleteBuffers(1, &coordinateBuffer);
+	if (fadeTexture != 0)
+		glDeleteTextures(1, &fadeTexture);
+}
+
+int TrailSet::getTrailCount(void)
+{
+	return trailCount;
+}
+
+void TrailSet::clear(int first, int count)
+{
+	for (int i = first; i < first + count && i < trailCount; i++)
+	{
+		counts[i] = 0;
+	}
+}
+
+void TrailSet::setPoint(int trail, const float* position)
+{
+	if (trail < 0 || trail >= trailCount)
+		return;
+
+	// the first slot is repeated at the end, so the ring can be drawn across its seam
+	int slot = (int)(sample % length);
+	float* point = &points[((size_t)trail * stride + slot) * 3];
+	for (int i = 0; i < 3; i++)
+	{
+		point[i] = position[i] - origin[i];
+		if (slot == 0)
+			point[length * 3 + i] = point[i];
+	}
+	if (counts[trail] < length)
+		counts[trail]++;
+}
+
+void TrailSet::nextSample(void)
+{
+	sample++;
+}
+
+void TrailSet::shift(const float* offset)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		origin[i] += offset[i];
+	}
+}
+
+void TrailSet::createObjects(void)
+{
+	GLExtensions& gl = glExtensions;
+	GLsizeiptr size = (GLsizeiptr)(points.size() * sizeof(float));
+	mode = MODE_CLIENT;
+	if (gl.persistentBuffers)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		gl.genBuffers(1, &vertexBuffer);
+		gl.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		gl.bufferStorage(GL_ARRAY_BUFFER, size * copyCount, NULL, flags);
+		mapped = (float*)gl.mapBufferRange(GL_ARRAY_BUFFER, 0, size * copyCount, flags);
+		if (mapped != NULL)
+		{
+			mode = MODE_PERSISTENT;
+		}
+		else
+		{
+			gl.deleteBuffers(1, &vertexBuffer);
+			vertexBuffer = 0;
+		}
+	}
+	if (mode == MODE_CLIENT && gl.buffers)
+	{
+		gl.genBuffers(1, &vertexBuffer);
+		gl.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		gl.bufferData(GL_ARRAY_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+		mode = MODE_MAPPED;
+	}
+	if (mode != MODE_CLIENT)
+	{
+		gl.genBuffers(1, &coordinateBuffer);
+		gl.bindBuffer(GL_ARRAY_BUFFER, coordinateBuffer);
+		gl.bufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(coordinates.size() * sizeof(float)), &coordinates[0], GL_STATIC_DRAW);
+		gl.bindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	// solid at the newest point, gone at the oldest
+	unsigned char fade[fadeSize];
+	for (int i = 0; i < fadeSize; i++)
+	{
+		fade[i] = (unsigned char)(255 * i / (fadeSize - 1));
+	}
+	glGenTextures(1, &fadeTexture);
+	glBindTexture(GL_TEXTURE_1D, fadeTexture);
+	glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+	glTexImage1D(GL_TEXTURE_1D, 0, GL_ALPHA, fadeSize, 0, GL_ALPHA, GL_UNSIGNED_BYTE, fade);
+}
+
+size_t TrailSet::copySamples(float* target, uint64_t from)
+{
+	// a copy that missed a whole ring takes everything
+	if (sample - from >= (uint64_t)length)
+	{
+		memcpy(target, &points[0], points.size() * sizeof(float));
+		return points.size() * sizeof(float);
+	}
+	size_t bytes = 0;
+	for (uint64_t s = from; s < sample; s++)
+	{
+		int slot = (int)(s % length);
+		for (int i = 0; i < trailCount; i++)
+		{
+			size_t offset = ((size_t)i * stride + slot) * 3;
+			memcpy(target + offset, &points[offset], 3 * sizeof(float));
+			if (slot == 0)
+				memcpy(target + offset + length * 3, &points[offset + length * 3], 3 * sizeof(float));
+			bytes += (slot == 0 ? 6 : 3) * sizeof(float);
+		}
+	}
+	return bytes;
+}
+
+void TrailSet::drawRanges(int index)
+{
+	int ranges = 0, vertices = 0;
+	int head = (int)(sample % length);
+	for (int i = 0; i < trailCount; i++)
+	{
+		// the older part runs up to the end of the ring and over the seam, the newer part from the start to the head
+		int first, size;
+		if (index == 0)
+		{
+			if (counts[i] <= head)
+				continue;
+			first = length - (counts[i] - head);
+			size = counts[i] - head + (head > 0 ? 1 : 0);
+		}
+		else
+		{
+			first = head - (counts[i] < head ? counts[i] : head);
+			size = head - first;
+		}
+		if (size < 2)
+			continue;
+		firsts[index][ranges] = i * stride + first;
+		sizes[index][ranges] = size;
+		ranges++;
+		vertices += size;
+	}
+	if (ranges == 0)
+		return;
+
+	GLExtensions& gl = glExtensions;
+	if (gl.multiDraw)
+	{
+		gl.multiDrawArrays(GL_LINE_STRIP, &firsts[index][0], &sizes[index][0], ranges);
+		glCalls.drawCalls++;
+	}
+	else
+	{
+		for (int i = 0; i < ranges; i++)
+		{
+			glDrawArrays(GL_LINE_STRIP, firsts[index][i], sizes[index][i]);
+		}
+	}
+	verticesSubmitted.add(vertices);
+}
+
+void TrailSet::render(const float* color)
+{
+	GLExtensions& gl = glExtensions;
+	if (mode == MODE_NONE)
+		createObjects();
+
+	// bring the copy to draw from up to date, once the card is done with it
+	const float* vertices = &points[0];
+	if (mode == MODE_PERSISTENT)
+	{
+		if (fences[copy] != NULL)
+		{
+			GLenum waited = gl.clientWaitSync(fences[copy], GL_SYNC_FLUSH_COMMANDS_BIT, fenceTimeout);
+			while (waited == GL_TIMEOUT_EXPIRED)
+			{
+				waited = gl.clientWaitSync(fences[copy], 0, fenceTimeout);
+			}
+			gl.deleteSync(fences[copy]);
+			fences[copy] = NULL;
+		}
+		bytesUploaded.add(copySamples(mapped + points.size() * copy, synced[copy]));
+		synced[copy] = sample;
+		gl.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		vertices = (const float*)(points.size() * copy * sizeof(float));
+	}
+	else if (mode == MODE_MAPPED)
+	{
+		gl.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		float* target = (float*)gl.mapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
+		if (target != NULL)
+		{
+			bytesUploaded.add(copySamples(target, synced[0]));
+			synced[0] = sample;
+		}
+		gl.unmapBuffer(GL_ARRAY_BUFFER);
+		vertices = NULL;
+	}
+
+	glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_CURRENT_BIT | GL_TEXTURE_BIT);
+	glDisable(GL_TEXTURE_2D);
+	glDisable(GL_LIGHTING);
+	glEnable(GL_TEXTURE_1D);
+	glBindTexture(GL_TEXTURE_1D, fadeTexture);
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDepthMask(GL_FALSE);
+	glColor4f(color[0], color[1], color[2], 1.0f);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, vertices);
+	if (mode != MODE_CLIENT)
+	{
+		gl.bindBuffer(GL_ARRAY_BUFFER, coordinateBuffer);
+		glTexCoordPointer(1, GL_FLOAT, 0, NULL);
+	}
+	else
+	{
+		glTexCoordPointer(1, GL_FLOAT, 0, &coordinates[0]);
+	}
+
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glTranslatef(origin[0], origin[1], origin[2]);
+
+	// shift the coordinates so the newest point is at the clear end of the fade, in both parts of the rings
+	int head = (int)(sample % length);
+	glMatrixMode(GL_TEXTURE);
+	glPushMatrix();
+	glLoadIdentity();
+	glTranslatef(-(float)head / length, 0.0f, 0.0f);
+	drawRanges(0);
+	glLoadIdentity();
+	glTranslatef((float)(length - head) / length, 0.0f, 0.0f);
+	drawRanges(1);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopMatrix();
+
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	if (mode != MODE_CLIENT)
+		gl.bindBuffer(GL_ARRAY_BUFFER, 0);
+	glPopAttrib();
+
+	// the next frame writes the next copy while this one is drawn
+	if (mode == MODE_PERSISTENT)
+	{
+		fences[copy] = gl.fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		copy = (copy + 1) % copyCount;
+	}
+}
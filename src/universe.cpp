@@ -0,0 +1,406 @@
+#include "universe.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include "random.h"
+
+// one in this many sectors holds a solar system
+static const int occupancy = 4;
+
+bool Universe::SectorKey::operator<(const SectorKey& other) const
+{
+	if (x != other.x)
+		return x < other.x;
+	if (y != other.y)
+		return y < other.y;
+	return z < other.z;
+}
+
+int Universe::sectorDistance(const SectorKey& a, const SectorKey& b)
+{
+	int dx = abs(a.x - b.x), dy = abs(a.y - b.y), dz = abs(a.z - b.z);
+	return std::max(dx, std::max(dy, dz));
+}
+
+Universe::Universe(DestinationBuilder* builder, uint64_t seed, int threadCount, JobSystem* jobs)
+{
+	this->builder = builder;
+	this->jobs = jobs;
+	this->visibleCount = 0;
+	this->seed = seed;
+	this->stopping = false;
+	current.x = current.y = current.z = 0;
+	prefetching = false;
+	target = current;
+	emptySystem = new SolarSystem(std::vector<BodyDesc>());
+
+	// the home sector is there right from the start
+	Sector home;
+	home.key = current;
+	bool occupied;
+	uint64_t id = systemId(home.key, &occupied);
+	home.system = builder->build(id);
+	sectors[home.key] = home;
+
+	if (threadCount < 1)
+		threadCount = 1;
+	for (int i = 0; i < threadCount; i++)
+	{
+		workers.push_back(std::thread(&Universe::run, this));
+	}
+	page();
+}
+
+Universe::~Universe(void)
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (int i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+
+	for (std::map<SectorKey, Sector>::iterator i = sectors.begin(); i != sectors.end(); i++)
+	{
+		delete i->second.system;
+	}
+	for (int i = 0; i < built.size(); i++)
+	{
+		delete built[i].system;
+	}
+	delete emptySystem;
+}
+
+uint64_t Universe::systemId(const SectorKey& key, bool* occupied)
+{
+	// the home sector holds the first system of the catalog
+	if (key.x == 0 && key.y == 0 && key.z == 0)
+	{
+		*occupied = true;
+		return 0;
+	}
+	uint64_t hash = Random::combine(Random::combine((uint32_t)key.x, (uint32_t)key.y), (uint32_t)key.z);
+	Random random(Random::combine(seed, hash));
+	*occupied = random.range(occupancy) == 0;
+	return builder->generatedId(random.next());
+}
+
+void Universe::run(void)
+{
+	std::unique_lock<std::mutex> guard(lock);
+	while (true)
+	{
+		while (queue.empty() && !stopping)
+		{
+			wake.wait(guard);
+		}
+		if (stopping)
+			return;
+
+		Sector sector;
+		sector.key = queue.front();
+		queue.pop_front();
+		building[sector.key] = true;
+		guard.unlock();
+
+		bool occupied;
+		uint64_t id = systemId(sector.key, &occupied);
+		sector.system = occupied ? builder->build(id) : NULL;
+
+		guard.lock();
+		building.erase(sector.key);
+		built.push_back(sector);
+	}
+}
+
+bool Universe::wanted(const SectorKey& key)
+{
+	return sectorDistance(key, current) <= pageRadius || (prefetching && sectorDistance(key, target) <= 1);
+}
+
+void Universe::page(void)
+{
+	// drop sectors that are far away
+	for (std::map<SectorKey, Sector>::iterator i = sectors.begin(); i != sectors.end();)
+	{
+		if (!wanted(i->first))
+		{
+			builder->retire(i->second.system);
+			sectors.erase(i++);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	// ask for the missing ones, nearest first
+	std::vector<std::pair<int, SectorKey> > missing;
+	std::lock_guard<std::mutex> guard(lock);
+	for (int x = -pageRadius; x <= pageRadius; x++)
+	{
+		for (int y = -pageRadius; y <= pageRadius; y++)
+		{
+			for (int z = -pageRadius; z <= pageRadius; z++)
+			{
+				SectorKey key = {current.x + x, current.y + y, current.z + z};
+				if (sectors.find(key) == sectors.end() && building.find(key) == building.end())
+					missing.push_back(std::make_pair(x * x + y * y + z * z, key));
+			}
+		}
+	}
+	std::sort(missing.begin(), missing.end(), [](const std::pair<int, SectorKey>& a, const std::pair<int, SectorKey>& b) { return a.first < b.first; });
+
+	// the old queue is replaced, sectors that aren't wanted anymore are never built,
+	// and the sectors around the prefetch target come first
+	queue.clear();
+	if (prefetching)
+	{
+		for (int x = -1; x <= 1; x++)
+		{
+			for (int y = -1; y <= 1; y++)
+			{
+				for (int z = -1; z <= 1; z++)
+				{
+					SectorKey key = {target.x + x, target.y + y, target.z + z};
+					if (sectors.find(key) == sectors.end() && building.find(key) == building.end() && sectorDistance(key, current) > pageRadius)
+						queue.push_back(key);
+				}
+			}
+		}
+	}
+	for (int i = 0; i < missing.size(); i++)
+	{
+		queue.push_back(missing[i].second);
+	}
+	wake.notify_all();
+}
+
+void Universe::collect(void)
+{
+	std::vector<Sector> arrived;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		arrived.swap(built);
+	}
+	for (int i = 0; i < arrived.size(); i++)
+	{
+		// the camera may have moved away while the sector was built
+		if (!wanted(arrived[i].key) || sectors.find(arrived[i].key) != sectors.end())
+			builder->retire(arrived[i].system);
+		else
+			sectors[arrived[i].key] = arrived[i];
+	}
+}
+
+void Universe::update(Camera& camera)
+{
+	collect();
+
+	// keep the camera within its sector, moving the origin along when it leaves
+	float position[3];
+	camera.getPosition(position);
+	int move[3] = {0, 0, 0};
+	for (int i = 0; i < 3; i++)
+	{
+		while (position[i] + move[i] * -sectorSize >= sectorSize / 2)
+			move[i]++;
+		while (position[i] + move[i] * -sectorSize < -sectorSize / 2)
+			move[i]--;
+	}
+	if (move[0] == 0 && move[1] == 0 && move[2] == 0)
+		return;
+
+	float shift[3] = {-move[0] * sectorSize, -move[1] * sectorSize, -move[2] * sectorSize};
+	camera.shift(shift);
+	current.x += move[0];
+	current.y += move[1];
+	current.z += move[2];
+	page();
+}
+
+void Universe::moveTo(const int* sector)
+{
+	prefetching = false;
+	current.x = sector[0];
+	current.y = sector[1];
+	current.z = sector[2];
+	collect();
+	page();
+}
+
+bool Universe::isBuilt(const int* sector)
+{
+	collect();
+	SectorKey key = {sector[0], sector[1], sector[2]};
+	return sectors.find(key) != sectors.end();
+}
+
+void Universe::prefetch(const int* sector)
+{
+	if (prefetching && target.x == sector[0] && target.y == sector[1] && target.z == sector[2])
+		return;
+	prefetching = true;
+	target.x = sector[0];
+	target.y = sector[1];
+	target.z = sector[2];
+	page();
+}
+
+void Universe::getSector(int* sector)
+{
+	sector[0] = current.x;
+	sector[1] = current.y;
+	sector[2] = current.z;
+}
+
+SolarSystem* Universe::getCurrentSystem(void)
+{
+	std::map<SectorKey, Sector>::iterator found = sectors.find(current);
+	if (found == sectors.end() || found->second.system == NULL)
+		return emptySystem;
+	return found->second.system;
+}
+
+void Universe::offsetOf(const SectorKey& key, float* offset)
+{
+	offset[0] = (key.x - current.x) * sectorSize;
+	offset[1] = (key.y - current.y) * sectorSize;
+	offset[2] = (key.z - current.z) * sectorSize;
+}
+
+void Universe::gatherVisible(int radius)
+{
+	visibleCount = 0;
+	for (std::map<SectorKey, Sector>::iterator i = sectors.begin(); i != sectors.end(); i++)
+	{
+		if (i->second.system == NULL || sectorDistance(i->first, current) > radius)
+			continue;
+
+		// the entries are reused from frame to frame so their lists keep their memory
+		if (visibleCount == visible.size())
+			visible.push_back(Visible());
+		Visible& entry = visible[visibleCount++];
+		entry.system = i->second.system;
+		offsetOf(i->first, entry.offset);
+	}
+}
+
+void Universe::moveSystems(void* data, int begin, int end)
+{
+	Universe* universe = (Universe*)data;
+	for (int i = begin; i < end; i++)
+	{
+		universe->visible[i].system->calculatePositions(universe->frameTime);
+	}
+}
+
+void Universe::cullSystems(void* data, int begin, int end)
+{
+	Universe* universe = (Universe*)data;
+	for (int i = begin; i < end; i++)
+	{
+		Visible& entry = universe->visible[i];
+		RenderView view;
+		universe->frameView.translate(entry.offset, &view);
+		entry.system->buildRenderList(view, entry.items);
+	}
+}
+
+void Universe::calculatePositions(const SimulationTime& time)
+{
+	gatherVisible(renderRadius);
+	frameTime = time;
+	if (jobs != NULL)
+		jobs->parallelFor(visibleCount, 1, moveSystems, this);
+	else
+		moveSystems(this, 0, visibleCount);
+}
+
+float Universe::testDistancewithPlanet(Camera& camera)
+{
+	float min_distance = 10000.0f;
+	for (std::map<SectorKey, Sector>::iterator i = sectors.begin(); i != sectors.end(); i++)
+	{
+		if (i->second.system == NULL || sectorDistance(i->first, current) > collisionRadius)
+			continue;
+
+		// the camera as seen from the system
+		float offset[3], position[3];
+		offsetOf(i->first, offset);
+		camera.getPosition(position);
+		for (int j = 0; j < 3; j++)
+		{
+			position[j] -= offset[j];
+		}
+		float gap = i->second.system->testDistancewithPlanet(position);
+		if (gap < min_distance)
+			min_distance = gap;
+	}
+	return min_distance;
+}
+
+float Universe::testDistancewithWormhole(Camera& camera)
+{
+	float min_distance = 10000.0f;
+	for (std::map<SectorKey, Sector>::iterator i = sectors.begin(); i != sectors.end(); i++)
+	{
+		if (i->second.system == NULL || sectorDistance(i->first, current) > collisionRadius)
+			continue;
+
+		float offset[3], position[3];
+		offsetOf(i->first, offset);
+		camera.getPosition(position);
+		for (int j = 0; j < 3; j++)
+		{
+			position[j] -= offset[j];
+		}
+		float gap = i->second.system->testDistancewithWormhole(position);
+		if (gap < min_distance)
+			min_distance = gap;
+	}
+	return min_distance;
+}
+
+bool Universe::pick(Camera& camera, float* center)
+{
+	float direction[3], nearest = 10000.0f;
+	camera.getViewDirection(direction);
+	bool found = false;
+	for (std::map<SectorKey, Sector>::iterator i = sectors.begin(); i != sectors.end(); i++)
+	{
+		if (i->second.system == NULL || sectorDistance(i->first, current) > renderRadius)
+			continue;
+
+		float offset[3], position[3], hit[3];
+		offsetOf(i->first, offset);
+		camera.getPosition(position);
+		for (int j = 0; j < 3; j++)
+		{
+			position[j] -= offset[j];
+		}
+		if (i->second.system->pick(position, direction, hit) < 0)
+			continue;
+
+		// keep the hit closest to the camera
+		float distance = 0.0f;
+		for (int j = 0; j < 3; j++)
+		{
+			distance += (hit[j] - position[j]) * (hit[j] - position[j]);
+		}
+		distance = sqrt(distance);
+		if (distance < nearest)
+		{
+			nearest = distance;
+			found = true;
+			for (int j = 0; j < 3; j++)
+			{
+				center[j] = hit[j] + offset[j];
+			}
+		}
+	}
+	return found;
+}
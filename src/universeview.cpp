@@ -0,0 +1,46 @@
+#include "universe.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+#include <glut.h>
+#include "glcount.h"
+
+void Universe::render(void)
+{
+	// systems are culled on all cores, only drawing is left to this thread
+	gatherVisible(renderRadius);
+	frameView.capture();
+	if (jobs != NULL)
+		jobs->parallelFor(visibleCount, 1, cullSystems, this);
+	else
+		cullSystems(this, 0, visibleCount);
+
+	GLfloat lightPosition[] = {0.0, 0.0, 0.0, 1.0};
+	for (int i = 0; i < visibleCount; i++)
+	{
+		// every system is lit by its own sun
+		Visible& entry = visible[i];
+		glPushMatrix();
+		glTranslatef(entry.offset[0], entry.offset[1], entry.offset[2]);
+		glLightfv(GL_LIGHT0, GL_POSITION, lightPosition);
+		entry.system->submit(entry.items);
+		glPopMatrix();
+	}
+}
+
+void Universe::renderOrbits(void)
+{
+	for (std::map<SectorKey, Sector>::iterator i = sectors.begin(); i != sectors.end(); i++)
+	{
+		if (i->second.system == NULL || sectorDistance(i->first, current) > renderRadius)
+			continue;
+
+		float offset[3];
+		offsetOf(i->first, offset);
+		glPushMatrix();
+		glTranslatef(offset[0], offset[1], offset[2]);
+		i->second.system->renderOrbits();
+		glPopMatrix();
+	}
+}
@@ -0,0 +1,119 @@
+// flights, checks scripted flight plans against a system of a catalog
+//
+//   flights <catalog.cat> <index> <plans.txt> [step] [threads]
+//
+// A file of plans is a list of lines, # starts a comment. Each plan is started by a line
+//   plan
+// and followed by its points, going forward in time
+//   <time> <x> <y> <z> <forward x> <forward y> <forward z> <up x> <up y> <up z>
+// with the time in days and the rest in the units of the game, the sun of the system at the origin.
+//
+// The system moves in steps of 0.01 days unless told otherwise, and for every plan a line of
+// comma-separated values gives its first contact, its smallest clearance and its wormhole entries.
+// Times are -1 for what never happened.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include "catalog.h"
+#include "flightplan.h"
+
+static const double defaultStep = 0.01;
+
+// read the plans, return false and leave a message if the file is broken
+static bool readPlans(const char* path, std::vector<FlightPlan>& plans)
+{
+	FILE* file = fopen(path, "r");
+	if (file == NULL)
+	{
+		fprintf(stderr, "can't open %s\n", path);
+		return false;
+	}
+
+	char line[512];
+	int number = 0;
+	bool valid = true;
+	while (valid && fgets(line, sizeof(line), file) != NULL)
+	{
+		number++;
+		char* comment = strchr(line, '#');
+		if (comment != NULL)
+			*comment = 0;
+		char word[16];
+		if (sscanf(line, "%15s", word) != 1)
+			continue;
+		if (strcmp(word, "plan") == 0)
+		{
+			plans.push_back(FlightPlan());
+			continue;
+		}
+
+		FlightPoint point;
+		valid = !plans.empty() && sscanf(line, "%lf %f %f %f %f %f %f %f %f %f", &point.time,
+			&point.position[0], &point.position[1], &point.position[2], &point.forward[0], &point.forward[1],
+			&point.forward[2], &point.up[0], &point.up[1], &point.up[2]) == 10;
+		if (valid && !plans.back().points.empty() && point.time < plans.back().points.back().time)
+			valid = false;
+		if (valid)
+			plans.back().points.push_back(point);
+		else
+			fprintf(stderr, "%s:%d: expected a point after the last one of a plan\n", path, number);
+	}
+	fclose(file);
+	return valid;
+}
+
+static int usage(void)
+{
+	fprintf(stderr, "usage: flights <catalog.cat> <index> <plans.txt> [step] [threads]\n");
+	return 2;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 4 || argc > 6)
+		return usage();
+	uint64_t index = strtoull(argv[2], NULL, 10);
+	double step = argc > 4 ? atof(argv[4]) : defaultStep;
+	if (step <= 0.0)
+		return usage();
+
+	Catalog catalog;
+	if (!catalog.open(argv[1]))
+	{
+		fprintf(stderr, "%s is not a valid catalog\n", argv[1]);
+		return 1;
+	}
+	std::vector<BodyDesc> bodies;
+	if (!catalog.getSystem(index, std::vector<TextureHandle>(), bodies))
+	{
+		fprintf(stderr, "%s has no valid system %llu\n", argv[1], (unsigned long long)index);
+		return 1;
+	}
+	std::vector<FlightPlan> plans;
+	if (!readPlans(argv[3], plans))
+		return 1;
+
+	JobSystem jobs(argc > 5 ? atoi(argv[5]) : 0);
+	SolarSystem system(bodies);
+	FlightEvaluator evaluator(&system, &jobs, step);
+	std::vector<FlightReport> reports;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	evaluator.evaluate(plans, reports);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	printf("plan,contact_time,min_clearance,min_clearance_time,wormhole_entries,first_wormhole_time\n");
+	int contacts = 0;
+	for (int i = 0; i < reports.size(); i++)
+	{
+		const FlightReport& report = reports[i];
+		printf("%d,%g,%g,%g,%d,%g\n", i, report.contactTime, report.minClearance, report.minClearanceTime,
+			report.wormholeEntries, report.firstWormholeTime);
+		if (report.contactTime >= 0.0)
+			contacts++;
+	}
+	fprintf(stderr, "%d plans, %d with contact, %.3f s on %d threads\n", (int)plans.size(), contacts, seconds, jobs.getThreadCount());
+	return 0;
+}
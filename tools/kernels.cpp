@@ -0,0 +1,378 @@
+// kernels, measures the hot kernels of the game one by one
+//
+//   kernels [filter] [samples]
+//
+// Every kernel runs over a few sizes of input: systems of more and more bodies, longer arrays of
+// vectors and larger images. A run is timed in samples of at least 10 ms each, enough repetitions
+// to make a sample that long are found first, and the median of the samples is reported with the
+// fastest one and the median distance from the median, which stays put when a few samples are
+// disturbed. Nothing touches OpenGL, so the numbers only hold the kernels themselves.
+//
+// The output is comma-separated with a header, one line per kernel and size, and times are in
+// nanoseconds for one repetition. Only kernels whose names contain the filter are run.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include "solarsystem.h"
+#include "camera.h"
+#include "tga.h"
+#include "random.h"
+
+static const int defaultSamples = 15;
+static const double sampleSeconds = 0.01;
+
+static const int systemSizes[] = {16, 256, 4096, 65536};
+static const int systemSizeCount = 4;
+static const int vectorSizes[] = {64, 4096, 262144};
+static const int vectorSizeCount = 3;
+static const int imageSizes[] = {64, 256, 1024, 2048};
+static const int imageSizeCount = 4;
+
+// the places the distance to the bodies is tested from
+static const int probeCount = 64;
+
+// results are added here so the compiler can't drop the work
+static volatile float sink;
+
+static const char* filter = "";
+static int samples = defaultSamples;
+
+// run one repetition of a kernel
+typedef void (*Kernel)(void* data);
+
+static double secondsOf(Kernel kernel, void* data, long repetitions)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (long i = 0; i < repetitions; i++)
+	{
+		kernel(data);
+	}
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double median(std::vector<double> values)
+{
+	std::sort(values.begin(), values.end());
+	size_t middle = values.size() / 2;
+	return values.size() % 2 == 1 ? values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+}
+
+static void measure(const char* name, int size, Kernel kernel, void* data)
+{
+	if (strstr(name, filter) == NULL)
+		return;
+
+	// the first runs warm the caches and find how many repetitions fill a sample
+	long repetitions = 1;
+	while (secondsOf(kernel, data, repetitions) < sampleSeconds)
+	{
+		repetitions *= 2;
+	}
+
+	std::vector<double> times(samples);
+	for (int i = 0; i < samples; i++)
+	{
+		times[i] = secondsOf(kernel, data, repetitions) * 1e9 / repetitions;
+	}
+	double middle = median(times);
+	std::vector<double> deviations(samples);
+	for (int i = 0; i < samples; i++)
+	{
+		deviations[i] = fabs(times[i] - middle);
+	}
+	printf("%s,%d,%ld,%d,%.1f,%.1f,%.1f\n", name, size, repetitions, samples,
+		middle, *std::min_element(times.begin(), times.end()), median(deviations));
+	fflush(stdout);
+}
+
+// a system of planets with a moon each and a wormhole for every eight planets, on slightly eccentric orbits
+static std::vector<BodyDesc> describeSystem(int size, Random& random)
+{
+	std::vector<BodyDesc> descriptions;
+	BodyDesc sun = {BODY_PLANET, -1, 0.0f, 1.0f, 500.0f, 695500.0f, 1, {0.0f, 0.0f, 0.0f, 0.0f, 0.0f}};
+	descriptions.push_back(sun);
+	while ((int)descriptions.size() < size)
+	{
+		int kind = BODY_PLANET;
+		if (descriptions.size() > 1 && descriptions.back().kind == BODY_PLANET)
+			kind = BODY_MOON;
+		else if (random.range(8) == 0)
+			kind = BODY_WORMHOLE;
+		BodyDesc desc;
+		desc.kind = kind;
+		desc.parent = -1;
+		desc.distance = random.uniform(5e7f, 5e9f);
+		desc.orbitTime = random.uniform(50.0f, 90000.0f);
+		desc.rotationTime = random.uniform(0.4f, 250.0f);
+		desc.radius = random.uniform(1000.0f, 70000.0f);
+		desc.textureHandle = 2;
+		desc.elements.eccentricity = random.uniform(0.0f, 0.25f);
+		desc.elements.inclination = random.uniform(0.0f, 10.0f);
+		desc.elements.ascendingNode = random.uniform(0.0f, 360.0f);
+		desc.elements.periapsis = random.uniform(0.0f, 360.0f);
+		desc.elements.meanAnomaly = random.uniform(0.0f, 360.0f);
+		if (kind == BODY_MOON)
+		{
+			// the moon follows the planet just before it
+			desc.parent = (int)descriptions.size() - 1;
+			desc.distance = random.uniform(4e5f, 2e7f);
+			desc.orbitTime = random.uniform(1.0f, 60.0f);
+			desc.radius = random.uniform(100.0f, 3000.0f);
+		}
+		descriptions.push_back(desc);
+	}
+	return descriptions;
+}
+
+struct SystemData
+{
+	SolarSystem* system;
+	SimulationTime time;
+	float probes[probeCount][3];
+	int probe;
+};
+
+static void calculatePositions(void* data)
+{
+	SystemData* system = (SystemData*)data;
+	system->time.advance(0.01);
+	system->system->calculatePositions(system->time);
+}
+
+static void testDistancewithPlanet(void* data)
+{
+	SystemData* system = (SystemData*)data;
+	system->probe = (system->probe + 1) % probeCount;
+	sink = system->system->testDistancewithPlanet(system->probes[system->probe]);
+}
+
+static void testDistancewithWormhole(void* data)
+{
+	SystemData* system = (SystemData*)data;
+	system->probe = (system->probe + 1) % probeCount;
+	sink = system->system->testDistancewithWormhole(system->probes[system->probe]);
+}
+
+static void measureSystems(void)
+{
+	for (int i = 0; i < systemSizeCount; i++)
+	{
+		Random random(42 + i);
+		SolarSystem system(describeSystem(systemSizes[i], random));
+		SystemData data;
+		data.system = &system;
+		data.time.set(0.0);
+		data.probe = 0;
+		for (int j = 0; j < probeCount; j++)
+		{
+			vectorSet(data.probes[j], random.uniform(-50.0f, 50.0f), random.uniform(-50.0f, 50.0f), random.uniform(-2.0f, 2.0f));
+		}
+		system.calculatePositions(data.time);
+		measure("calculatePositions", systemSizes[i], calculatePositions, &data);
+		measure("testDistancewithPlanet", systemSizes[i], testDistancewithPlanet, &data);
+		measure("testDistancewithWormhole", systemSizes[i], testDistancewithWormhole, &data);
+	}
+}
+
+// arrays of unit vectors and angles, every repetition goes over all of them
+struct VectorData
+{
+	std::vector<float> vectors;
+	std::vector<float> axes;
+	std::vector<float> angles;
+	std::vector<float> results;
+	Camera camera;
+	int count;
+};
+
+static void normalizeVectors(void* data)
+{
+	VectorData* vectors = (VectorData*)data;
+	for (int i = 0; i < vectors->count; i++)
+	{
+		float* vec = &vectors->results[3 * i];
+		vectorCopy(vec, &vectors->vectors[3 * i]);
+		vectorMul(vec, 2.0f);
+		normalizeVec(vec);
+	}
+	sink = vectors->results[0];
+}
+
+static void rotationMatrices(void* data)
+{
+	VectorData* vectors = (VectorData*)data;
+	float matrix[9];
+	float sum = 0.0f;
+	for (int i = 0; i < vectors->count; i++)
+	{
+		rotationMatrix(matrix, &vectors->axes[3 * i], vectors->angles[i]);
+		sum += matrix[0];
+	}
+	sink = sum;
+}
+
+static void rotateVectors(void* data)
+{
+	VectorData* vectors = (VectorData*)data;
+	for (int i = 0; i < vectors->count; i++)
+	{
+		rotateAroundVec(&vectors->vectors[3 * i], &vectors->axes[3 * i], vectors->angles[i], &vectors->results[3 * i]);
+	}
+	sink = vectors->results[0];
+}
+
+static void transformWithMouse(void* data)
+{
+	VectorData* vectors = (VectorData*)data;
+	float up[3], right[3];
+	for (int i = 0; i < vectors->count; i++)
+	{
+		vectors->camera.transformWithMouse(vectors->angles[i], -vectors->angles[i], &vectors->results[3 * i], up, right);
+	}
+	sink = vectors->results[0];
+}
+
+static void randomUnitVector(float* vec, Random& random)
+{
+	vectorSet(vec, random.uniform(-1.0f, 1.0f), random.uniform(-1.0f, 1.0f), random.uniform(-1.0f, 1.0f));
+	if (lengthOfVec(vec) < 1e-3f)
+		vectorSet(vec, 0.0f, 0.0f, 1.0f);
+	normalizeVec(vec);
+}
+
+static void measureVectors(void)
+{
+	for (int i = 0; i < vectorSizeCount; i++)
+	{
+		int count = vectorSizes[i];
+		Random random(7 + i);
+		VectorData data;
+		data.count = count;
+		data.vectors.resize(3 * count);
+		data.axes.resize(3 * count);
+		data.angles.resize(count);
+		data.results.resize(3 * count);
+		for (int j = 0; j < count; j++)
+		{
+			randomUnitVector(&data.vectors[3 * j], random);
+			randomUnitVector(&data.axes[3 * j], random);
+			data.angles[j] = random.uniform(-1.5f, 1.5f);
+		}
+		measure("normalizeVec", count, normalizeVectors, &data);
+		measure("rotationMatrix", count, rotationMatrices, &data);
+		measure("rotateAroundVec", count, rotateVectors, &data);
+		measure("transformWithMouse", count, transformWithMouse, &data);
+	}
+}
+
+// the bytes of an image file of the given size, bands of color with noise in between like the maps of planets
+static std::vector<unsigned char> encodeImage(int size, bool runLength, Random& random)
+{
+	unsigned char header[18] = {0};
+	header[2] = runLength ? 10 : 2;
+	header[12] = size & 0xFF;
+	header[13] = size >> 8;
+	header[14] = size & 0xFF;
+	header[15] = size >> 8;
+	header[16] = 24;
+	std::vector<unsigned char> file(header, header + sizeof(header));
+
+	std::vector<unsigned char> pixels(3 * size);
+	for (int r = 0; r < size; r++)
+	{
+		for (int c = 0; c < size; c++)
+		{
+			bool band = (c / 16 + r / 32) % 2 == 0;
+			unsigned char value = band ? (unsigned char)(r * 255 / size) : (unsigned char)random.range(256);
+			pixels[3 * c] = value;
+			pixels[3 * c + 1] = band ? 0x40 : value;
+			pixels[3 * c + 2] = band ? 0x80 : (unsigned char)(value ^ 0x5A);
+		}
+		if (!runLength)
+		{
+			file.insert(file.end(), pixels.begin(), pixels.end());
+			continue;
+		}
+
+		// packets of up to 128 pixels never cross a row
+		int c = 0;
+		while (c < size)
+		{
+			int run = 1;
+			while (c + run < size && run < 128 && memcmp(&pixels[3 * c], &pixels[3 * (c + run)], 3) == 0)
+			{
+				run++;
+			}
+			if (run > 1)
+			{
+				file.push_back((unsigned char)(0x80 | (run - 1)));
+				file.insert(file.end(), &pixels[3 * c], &pixels[3 * c] + 3);
+				c += run;
+				continue;
+			}
+			int raw = 1;
+			while (c + raw < size && raw < 128 && memcmp(&pixels[3 * (c + raw - 1)], &pixels[3 * (c + raw)], 3) != 0)
+			{
+				raw++;
+			}
+			file.push_back((unsigned char)(raw - 1));
+			file.insert(file.end(), &pixels[3 * c], &pixels[3 * (c + raw)]);
+			c += raw;
+		}
+	}
+	return file;
+}
+
+struct ImageData
+{
+	std::vector<unsigned char> file;
+	TGAImage image;
+};
+
+static void decodeImage(void* data)
+{
+	ImageData* image = (ImageData*)data;
+	if (!TGA::decode(&image->file[0], image->file.size(), &image->image))
+	{
+		fprintf(stderr, "the image doesn't decode\n");
+		exit(1);
+	}
+	sink = image->image.pixels[0];
+}
+
+static void measureImages(void)
+{
+	for (int i = 0; i < imageSizeCount; i++)
+	{
+		Random random(99 + i);
+		ImageData data;
+		data.file = encodeImage(imageSizes[i], false, random);
+		measure("TGA::decode raw", imageSizes[i], decodeImage, &data);
+		data.file = encodeImage(imageSizes[i], true, random);
+		measure("TGA::decode rle", imageSizes[i], decodeImage, &data);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc > 1)
+		filter = argv[1];
+	if (argc > 2)
+		samples = atoi(argv[2]);
+	if (samples < 1)
+	{
+		fprintf(stderr, "usage: kernels [filter] [samples]\n");
+		return 2;
+	}
+
+	printf("kernel,size,repetitions,samples,median_ns,min_ns,mad_ns\n");
+	measureSystems();
+	measureVectors();
+	measureImages();
+	return 0;
+}
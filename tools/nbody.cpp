@@ -0,0 +1,161 @@
+// nbody, measures the gravity simulation
+//
+//   nbody <bodies> [threads]
+//
+// A ring of bodies around a heavy sun is pulled with the tree for a few values of theta,
+// and against the exact pull as long as there are few enough bodies to work it out.
+// Then it runs a few steps and prints how far the energy drifted.
+// First of all it checks that bodies on top of each other, more than fit in a leaf of the tree
+// or walk it together, are still pulled, and fails if they aren't.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include "gravity.h"
+#include "jobsystem.h"
+
+// the exact pull takes too long beyond this
+static const int exactLimit = 20000;
+
+static const float thetas[] = {0.3f, 0.5f, 0.7f, 1.0f};
+static const int thetaCount = 4;
+
+static const int energySteps = 20;
+static const double energyStep = 0.001;
+
+// bodies at the very same place, more than a group of the tree holds
+static const int coincidentCount = 100;
+
+// pull a pile of bodies at one place with the tree and exactly, return the mean relative error
+static double checkCoincident(JobSystem* jobs)
+{
+	GravitySimulation simulation(jobs);
+	GravityBody sun = {{0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}, 1.0};
+	simulation.add(sun);
+	GravityBody pile = {{1.0, 0.5, 0.25}, {0.0, 0.0, 0.0}, 1e-6};
+	for (int i = 0; i < coincidentCount; i++)
+	{
+		simulation.add(pile);
+	}
+
+	// the tree goes first, so a body it leaves out keeps no acceleration from the exact pull
+	int total = simulation.getBodyCount();
+	std::vector<double> tree(3 * total);
+	simulation.accelerate(false);
+	for (int i = 0; i < total; i++)
+	{
+		simulation.getAcceleration(i, &tree[3 * i]);
+	}
+	simulation.accelerate(true);
+	double error = 0.0;
+	for (int i = 0; i < total; i++)
+	{
+		double a[3], difference = 0.0, length = 0.0;
+		simulation.getAcceleration(i, a);
+		for (int j = 0; j < 3; j++)
+		{
+			double d = tree[3 * i + j] - a[j];
+			difference += d * d;
+			length += a[j] * a[j];
+		}
+		error += length > 0.0 ? sqrt(difference / length) : sqrt(difference);
+	}
+	return error / total;
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int usage(void)
+{
+	fprintf(stderr, "usage: nbody <bodies> [threads]\n");
+	return 2;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+		return usage();
+	int count = atoi(argv[1]);
+	if (count < 1)
+		return usage();
+	JobSystem jobs(argc > 2 ? atoi(argv[2]) : 0);
+	double coincidentError = checkCoincident(&jobs);
+	printf("%d coincident bodies   error %.2e\n", coincidentCount, coincidentError);
+	if (!(coincidentError < 1e-3))
+	{
+		fprintf(stderr, "bodies on top of each other are not pulled right\n");
+		return 1;
+	}
+
+	GravitySimulation simulation(&jobs);
+
+	GravityBody sun = {{0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}, 1.0};
+	simulation.add(sun);
+	simulation.addRing(count, 1.0, 2.0, 1.0, 1e-3, 42);
+	simulation.removeDrift();
+	int total = simulation.getBodyCount();
+	bool exact = total <= exactLimit;
+	printf("%d bodies on %d threads\n", total, jobs.getThreadCount());
+
+	// the exact pull only needs to be worked out once
+	std::vector<double> reference(3 * total);
+	if (exact)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		simulation.accelerate(true);
+		double elapsed = millisecondsSince(start);
+		for (int i = 0; i < total; i++)
+		{
+			simulation.getAcceleration(i, &reference[3 * i]);
+		}
+		printf("exact       %9.2f ms\n", elapsed);
+	}
+
+	for (int t = 0; t < thetaCount; t++)
+	{
+		simulation.setTheta(thetas[t]);
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		simulation.accelerate(false);
+		double elapsed = millisecondsSince(start);
+		printf("theta %.1f   %9.2f ms", thetas[t], elapsed);
+		if (exact)
+		{
+			// mean relative error of the accelerations
+			double error = 0.0;
+			for (int i = 0; i < total; i++)
+			{
+				double a[3], difference = 0.0, length = 0.0;
+				simulation.getAcceleration(i, a);
+				for (int j = 0; j < 3; j++)
+				{
+					double d = a[j] - reference[3 * i + j];
+					difference += d * d;
+					length += reference[3 * i + j] * reference[3 * i + j];
+				}
+				if (length > 0.0)
+					error += sqrt(difference / length);
+			}
+			printf("   error %.2e", error / total);
+		}
+		printf("\n");
+	}
+
+	simulation.setTheta(0.7f);
+	double energy = exact ? simulation.getEnergy() : 0.0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < energySteps; i++)
+	{
+		simulation.step(energyStep);
+	}
+	double elapsed = millisecondsSince(start);
+	printf("%d steps   %9.2f ms per step", energySteps, elapsed / energySteps);
+	if (exact && energy != 0.0)
+		printf("   energy drift %.2e", (simulation.getEnergy() - energy) / fabs(energy));
+	printf("\n");
+	return 0;
+}
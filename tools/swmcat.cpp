@@ -0,0 +1,196 @@
+// swmcat, the command line tool for catalogs of solar systems
+//
+//   swmcat compile <source.txt> <catalog.cat>
+//   swmcat generate <count> <catalog.cat> [seed] [threads]
+//   swmcat show <catalog.cat> <index>
+//
+// Generated systems are made on all cores a block at a time, so catalogs of millions
+// of systems only ever hold one block in memory.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include "catalog.h"
+#include "systemgenerator.h"
+#include "random.h"
+
+// systems generated at a time
+static const uint64_t generateBlock = 65536;
+
+// generated bodies for a range of systems
+struct GeneratedRange
+{
+	std::vector<BodyRecord> records;
+	std::vector<uint32_t> counts;
+};
+
+static void generateRange(const SystemGenerator* generator, uint64_t seed, uint64_t first, uint64_t count, GeneratedRange* range)
+{
+	std::vector<BodyDesc> bodies;
+	range->records.clear();
+	range->counts.clear();
+	for (uint64_t i = first; i < first + count; i++)
+	{
+		generator->generate(Random::combine(seed, i), bodies);
+		range->counts.push_back((uint32_t)bodies.size());
+		for (int j = 0; j < bodies.size(); j++)
+		{
+			BodyRecord record;
+			record.kind = bodies[j].kind;
+			record.parent = bodies[j].parent;
+			record.distance = bodies[j].distance;
+			record.orbitTime = bodies[j].orbitTime;
+			record.rotationTime = bodies[j].rotationTime;
+			record.radius = bodies[j].radius;
+
+			// the generator is given asset index + 1 as texture handles
+			record.asset = (int32_t)bodies[j].textureHandle - 1;
+			record.reserved = 0;
+			record.elements = bodies[j].elements;
+			range->records.push_back(record);
+		}
+	}
+}
+
+static int generate(uint64_t count, const char* path, uint64_t seed, int threadCount)
+{
+	std::vector<std::string> assets;
+	std::vector<TextureHandle> suns, planets;
+	for (int i = 0; i < generatedSunCount; i++)
+	{
+		assets.push_back(generatedSunImages[i]);
+		suns.push_back((TextureHandle)assets.size());
+	}
+	for (int i = 0; i < generatedPlanetCount; i++)
+	{
+		assets.push_back(generatedPlanetImages[i]);
+		planets.push_back((TextureHandle)assets.size());
+	}
+	assets.push_back(generatedWormholeImage);
+	SystemGenerator generator(suns, planets, (TextureHandle)assets.size());
+
+	CatalogWriter writer;
+	if (!writer.open(path, count, assets))
+	{
+		fprintf(stderr, "can't write %s\n", path);
+		return 1;
+	}
+
+	std::vector<GeneratedRange> ranges(threadCount);
+	for (uint64_t block = 0; block < count; block += generateBlock)
+	{
+		uint64_t blockSize = count - block < generateBlock ? count - block : generateBlock;
+		uint64_t share = (blockSize + threadCount - 1) / threadCount;
+
+		std::vector<std::thread> workers;
+		for (int t = 0; t < threadCount; t++)
+		{
+			uint64_t first = block + t * share;
+			uint64_t last = first + share < block + blockSize ? first + share : block + blockSize;
+			if (first >= last)
+			{
+				ranges[t].records.clear();
+				ranges[t].counts.clear();
+				continue;
+			}
+			workers.push_back(std::thread(generateRange, &generator, seed, first, last - first, &ranges[t]));
+		}
+		for (int t = 0; t < workers.size(); t++)
+		{
+			workers[t].join();
+		}
+
+		// systems are written in order, one thread's range after another
+		for (int t = 0; t < threadCount; t++)
+		{
+			size_t offset = 0;
+			for (int i = 0; i < ranges[t].counts.size(); i++)
+			{
+				if (!writer.addSystem(&ranges[t].records[offset], ranges[t].counts[i]))
+				{
+					fprintf(stderr, "can't write %s\n", path);
+					return 1;
+				}
+				offset += ranges[t].counts[i];
+			}
+		}
+	}
+
+	if (!writer.close())
+	{
+		fprintf(stderr, "can't write %s\n", path);
+		return 1;
+	}
+	return 0;
+}
+
+static int show(const char* path, uint64_t index)
+{
+	Catalog catalog;
+	if (!catalog.open(path))
+	{
+		fprintf(stderr, "%s is not a valid catalog\n", path);
+		return 1;
+	}
+
+	// pass asset indices as texture handles, so the names can be printed
+	std::vector<TextureHandle> textures;
+	for (uint32_t i = 0; i < catalog.getAssetCount(); i++)
+	{
+		textures.push_back(i);
+	}
+	std::vector<BodyDesc> bodies;
+	if (!catalog.getSystem(index, textures, bodies))
+	{
+		fprintf(stderr, "%s has no valid system %llu\n", path, (unsigned long long)index);
+		return 1;
+	}
+
+	static const char* kinds[] = {"planet", "moon", "wormhole"};
+	printf("system %llu of %llu\n", (unsigned long long)index, (unsigned long long)catalog.getSystemCount());
+	for (int i = 0; i < bodies.size(); i++)
+	{
+		const OrbitElements& elements = bodies[i].elements;
+		printf("%s %.0f %g %g %g %s %g %g %g %g %g\n", kinds[bodies[i].kind], bodies[i].distance, bodies[i].orbitTime,
+			bodies[i].rotationTime, bodies[i].radius, catalog.getAssetName(bodies[i].textureHandle), elements.eccentricity,
+			elements.inclination, elements.ascendingNode, elements.periapsis, elements.meanAnomaly);
+	}
+	return 0;
+}
+
+static int usage(void)
+{
+	fprintf(stderr, "usage: swmcat compile <source.txt> <catalog.cat>\n"
+		"       swmcat generate <count> <catalog.cat> [seed] [threads]\n"
+		"       swmcat show <catalog.cat> <index>\n");
+	return 2;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc == 4 && strcmp(argv[1], "compile") == 0)
+	{
+		std::string error;
+		if (!Catalog::compile(argv[2], argv[3], &error))
+		{
+			fprintf(stderr, "%s\n", error.c_str());
+			return 1;
+		}
+		return 0;
+	}
+	if (argc >= 4 && argc <= 6 && strcmp(argv[1], "generate") == 0)
+	{
+		uint64_t count = strtoull(argv[2], NULL, 10);
+		uint64_t seed = argc > 4 ? strtoull(argv[4], NULL, 10) : 0;
+		int threadCount = argc > 5 ? atoi(argv[5]) : (int)std::thread::hardware_concurrency();
+		if (threadCount < 1)
+			threadCount = 1;
+		return generate(count, argv[3], seed, threadCount);
+	}
+	if (argc == 4 && strcmp(argv[1], "show") == 0)
+		return show(argv[2], strtoull(argv[3], NULL, 10));
+	return usage();
+}